@@ -0,0 +1,51 @@
+#ifndef DATAEXCHANGE_H
+#define DATAEXCHANGE_H
+
+#include <cstddef>
+#include <string>
+
+#include "TaskManager.h"
+
+enum class ExchangeFormat { JSONL, CSV };
+
+struct ExchangeResult {
+  bool success = false;
+  size_t processed = 0;
+  size_t rejected = 0;
+};
+
+// Streaming import/export in JSON Lines and CSV. Output is encoded into a
+// single reusable buffer that is flushed every BATCH_SIZE tasks, and input
+// is read in CHUNK_SIZE blocks, so memory use does not grow with file size.
+// A record longer than MAX_RECORD_SIZE (e.g. an unterminated quoted CSV
+// field) is rejected and reading resumes at the next line.
+class DataExchange {
+ public:
+  static constexpr size_t BATCH_SIZE = 512;
+  static constexpr size_t CHUNK_SIZE = 64 * 1024;
+  static constexpr size_t MAX_RECORD_SIZE = 1024 * 1024;
+
+  static ExchangeResult exportTasks(
+    const TaskManager& manager,
+    const std::string& path,
+    ExchangeFormat format);
+  // Imported tasks are appended with fresh ids; everything else, including
+  // completion state and timestamps, is preserved.
+  static ExchangeResult importTasks(
+    TaskManager& manager,
+    const std::string& path,
+    ExchangeFormat format);
+
+  static bool formatFromPath(const std::string& path, ExchangeFormat& format);
+
+  static void appendJsonRecord(std::string& out, const Task& task);
+  static void appendCsvRecord(std::string& out, const Task& task);
+  static void appendCsvHeader(std::string& out);
+  static bool parseJsonRecord(const std::string& record, Task& task);
+
+ private:
+  static void appendJsonString(std::string& out, const std::string& value);
+  static void appendCsvField(std::string& out, const std::string& value);
+};
+
+#endif
@@ -1,23 +1,77 @@
 #ifndef FILEHANDLER_H
 #define FILEHANDLER_H
 
+#include <ctime>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 #include "TaskManager.h"
 
+// Identifies a version of the data file cheaply, without reading it. Only a
+// hint: saves alternate between recycled inodes and often keep the size,
+// and file system timestamps can be coarse, so two versions may look the
+// same. refresh() uses it to skip unchanged files; saves always check the
+// generation in the header.
+struct FileSignature {
+  bool exists = false;
+  unsigned long long inode = 0;
+  long long size = 0;
+  time_t modifiedAt = 0;
+  long modifiedNanos = 0;
+  time_t changedAt = 0;
+  long changedNanos = 0;
+
+  bool operator==(const FileSignature& other) const {
+    return exists == other.exists && inode == other.inode &&
+           size == other.size && modifiedAt == other.modifiedAt &&
+           modifiedNanos == other.modifiedNanos &&
+           changedAt == other.changedAt && changedNanos == other.changedNanos;
+  }
+};
+
+// Several instances may share one data file. Access is serialized with an
+// advisory lock on "<file>.lock", the header carries a generation counter
+// bumped by every save, and each record carries the generation it was last
+// written in, so an instance can pick up other instances' changes by
+// reparsing only the records whose version moved.
 class FileHandler {
  private:
   std::string filename;
+  std::string lockFilename;
+  std::string rejectedFilename;
+  size_t rejectedRecords;
+
+  // What this instance last read or wrote.
+  unsigned long long generation;
+  std::unordered_map<int, unsigned long long> recordVersions;
+  FileSignature signature;
 
  public:
   FileHandler(const std::string& filename = "data/tasks.dat");
 
   bool saveTasks(TaskManager& manager);
   bool loadTasks(TaskManager& manager);
+  // Applies changes saved by other instances since our last load or save;
+  // local unsaved changes win on conflict. Costs a single stat() when the
+  // file is unchanged. Returns true if any task changed.
+  bool refresh(TaskManager& manager);
   bool clearFile();
+  // Records that could not be parsed are skipped and copied verbatim to
+  // "<file>.rejected", so a later save does not silently lose them. The
+  // count covers the most recent read of the file.
+  size_t getRejectedCount() const {
+    return rejectedRecords;
+  }
+  const std::string& getRejectedFilename() const {
+    return rejectedFilename;
+  }
 
  private:
   void ensureDataDirectory();
+  FileSignature readSignature() const;
+  bool mergeFromFile(TaskManager& manager, bool force);
+  void keepRejected(const std::vector<std::string>& lines);
 };
 
 #endif
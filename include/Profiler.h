@@ -0,0 +1,87 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <ostream>
+#include <string>
+
+// Lightweight instrumentation for hot operations. Timers and counters are
+// only compiled in when TODO_ENABLE_PROFILING is defined; otherwise the
+// PROFILE_* macros expand to nothing and the registry stays empty.
+class Profiler {
+ public:
+  // Bucket i counts samples in [2^i, 2^(i+1)) nanoseconds; the last bucket
+  // also absorbs everything slower.
+  static constexpr int HISTOGRAM_BUCKETS = 36;
+
+  struct Metric {
+    uint64_t count = 0;
+    uint64_t totalNanos = 0;
+    uint64_t minNanos = UINT64_MAX;
+    uint64_t maxNanos = 0;
+    uint64_t buckets[HISTOGRAM_BUCKETS] = {};
+
+    uint64_t percentileNanos(double fraction) const;
+  };
+
+  class ScopedTimer {
+   private:
+    Metric& metric;
+    std::chrono::steady_clock::time_point start;
+
+   public:
+    explicit ScopedTimer(Metric& metric)
+        : metric(metric), start(std::chrono::steady_clock::now()) {}
+    ~ScopedTimer();
+
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+  };
+
+  static constexpr bool isEnabled() {
+#ifdef TODO_ENABLE_PROFILING
+    return true;
+#else
+    return false;
+#endif
+  }
+
+  static Metric& metric(const std::string& name);
+  static uint64_t& counter(const std::string& name);
+  static void record(Metric& metric, uint64_t nanos);
+  static void reset();
+
+  static void printReport(std::ostream& out);
+  static void dumpJson(std::ostream& out);
+
+ private:
+  static std::map<std::string, Metric>& metrics();
+  static std::map<std::string, uint64_t>& counters();
+};
+
+#define PROFILER_CONCAT_INNER(a, b) a##b
+#define PROFILER_CONCAT(a, b) PROFILER_CONCAT_INNER(a, b)
+
+#ifdef TODO_ENABLE_PROFILING
+#define PROFILE_SCOPE(name)                                            \
+  static Profiler::Metric& PROFILER_CONCAT(profilerMetric, __LINE__) = \
+    Profiler::metric(name);                                            \
+  Profiler::ScopedTimer PROFILER_CONCAT(profilerTimer, __LINE__)(      \
+    PROFILER_CONCAT(profilerMetric, __LINE__))
+#define PROFILE_COUNT(name, amount)                             \
+  do {                                                          \
+    static uint64_t& profilerCounter = Profiler::counter(name); \
+    profilerCounter += static_cast<uint64_t>(amount);           \
+  } while (0)
+#else
+#define PROFILE_SCOPE(name) \
+  do {                      \
+  } while (0)
+#define PROFILE_COUNT(name, amount) \
+  do {                              \
+  } while (0)
+#endif
+
+#endif
@@ -0,0 +1,60 @@
+#ifndef QUERY_H
+#define QUERY_H
+
+#include <cstddef>
+#include <optional>
+#include <string>
+
+#include "Task.h"
+
+enum class SortKey { NONE, ID, TITLE, DUE_DATE, PRIORITY, CREATED };
+
+// A conjunction of optional predicates plus ordering and a result limit.
+// Queries can be built field by field or parsed from expressions such as:
+//
+//   category:work AND priority>=high AND not done AND due<2026-01-01
+//   text:"quarterly report" sort:-priority limit:10
+struct Query {
+  std::optional<std::string> category;
+  std::optional<Priority> minPriority;
+  std::optional<Priority> maxPriority;
+  std::optional<bool> completed;
+  // Due date bounds in YYYY-MM-DD form; tasks without a due date never match
+  // a query that sets either bound.
+  std::optional<std::string> dueFrom;
+  bool dueFromInclusive = true;
+  std::optional<std::string> dueTo;
+  bool dueToInclusive = true;
+  std::optional<std::string> text;
+
+  SortKey sortKey = SortKey::NONE;
+  bool descending = false;
+  size_t limit = 0;  // 0 means no limit
+
+  bool hasDueRange() const {
+    return dueFrom.has_value() || dueTo.has_value();
+  }
+  bool matches(const Task& task) const;
+  // Everything except the text predicate, which callers evaluating many
+  // tasks check with containsText() against a pre-lowercased needle.
+  bool matchesFields(const Task& task) const;
+  bool matchesDueDate(const std::string& dueDate) const;
+  bool comesBefore(const Task& a, const Task& b) const;
+
+  static bool containsText(const Task& task, const std::string& lowerNeedle);
+  static bool parse(
+    const std::string& expression,
+    Query& query,
+    std::string& error);
+};
+
+enum class QuerySource { FULL_SCAN, CATEGORY_INDEX, DUE_DATE_INDEX };
+
+struct QueryPlan {
+  QuerySource source = QuerySource::FULL_SCAN;
+  size_t estimatedCandidates = 0;
+
+  std::string describe() const;
+};
+
+#endif
@@ -0,0 +1,75 @@
+#ifndef RECURRENCE_H
+#define RECURRENCE_H
+
+#include <cstdint>
+#include <string>
+
+enum class RecurrenceKind { NONE, DAILY, WEEKLY, MONTHLY, CRON };
+
+// How a task repeats. Rules are written as
+//
+//   daily[/N]                every N days
+//   weekly[/N][:mon,thu]     every N weeks, on the given weekdays (default:
+//                            the due date's weekday)
+//   monthly[/N][:D]          every N months on day D, clamped to the length
+//                            of the month (default: the due date's day)
+//   cron:<days> <months> <weekdays>
+//                            the date fields of a crontab line, with lists,
+//                            ranges, steps and names, e.g. "cron:1,15 * *"
+//                            or "cron:* * mon-fri"
+//
+// Due dates have no time of day, so cron rules stop at day granularity.
+class Recurrence {
+ private:
+  RecurrenceKind kind;
+  int interval;
+  int dayOfMonth;  // MONTHLY; 0 follows the due date
+  // WEEKLY and CRON weekdays (bit 0 = Sunday); CRON days of the month
+  // (bit d for day d) and months (bit m for month m).
+  uint8_t weekdays;
+  uint32_t monthDays;
+  uint16_t months;
+  bool anyMonthDay;
+  bool anyWeekday;
+  std::string cronFields;
+
+ public:
+  Recurrence();
+
+  // "" and "none" give a rule that never repeats.
+  static bool parse(
+    const std::string& text,
+    Recurrence& rule,
+    std::string& error);
+
+  bool isRecurring() const {
+    return kind != RecurrenceKind::NONE;
+  }
+  RecurrenceKind getKind() const {
+    return kind;
+  }
+  // Canonical form, accepted by parse().
+  std::string toString() const;
+
+  // First date strictly after `date` that the rule fires on; "" if `date`
+  // is not a valid date or the rule never fires again.
+  std::string nextAfter(const std::string& date) const;
+  // Due date of the occurrence that follows one due on `dueDate` (or, for a
+  // task with no due date, completed on `today`). Occurrences already in
+  // the past are skipped, so a late completion schedules a single catch-up.
+  std::string nextOccurrence(
+    const std::string& dueDate,
+    const std::string& today) const;
+  // Pins a monthly rule to the day of `dueDate`, so the day survives being
+  // clamped in shorter months.
+  Recurrence anchoredTo(const std::string& dueDate) const;
+
+  bool operator==(const Recurrence& other) const {
+    return toString() == other.toString();
+  }
+  bool operator!=(const Recurrence& other) const {
+    return !(*this == other);
+  }
+};
+
+#endif
@@ -0,0 +1,62 @@
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Task.h"
+
+struct ScheduledTask {
+  std::string dueDate;
+  int taskId;
+};
+
+// Min-heap of pending tasks keyed on due date, for reminders. A tick pops
+// only the entries that have come due, so it costs O(k log n) for k due
+// tasks rather than a scan. Entries are never updated in place: an edit
+// pushes a fresh entry, and entries whose task has since changed are
+// recognised and dropped when they reach the top.
+class Scheduler {
+ private:
+  std::vector<ScheduledTask> heap;
+  // The due date each task was last reported for, so duplicate entries
+  // (and rebuilds) never remind twice.
+  std::unordered_map<int, std::string> announced;
+  bool built;
+
+ public:
+  Scheduler() : built(false) {}
+
+  // TaskManager only maintains the heap once reminders have been asked for.
+  bool isBuilt() const {
+    return built;
+  }
+  void setBuilt(bool value) {
+    built = value;
+  }
+
+  // Ignores completed tasks and tasks without a due date.
+  void schedule(const Task& task);
+  // Lets a task be reported again for a due date it was already reported
+  // for (used when it is reopened).
+  void forget(int taskId);
+  // Drops every entry but remembers what has been reported.
+  void clear();
+  // Drops every entry and what has been reported.
+  void reset();
+  size_t size() const {
+    return heap.size();
+  }
+
+  // Pops the entries due on or before `horizon` and returns the ids of
+  // tasks not reported before. `isCurrent` tells whether an entry still
+  // matches its task.
+  std::vector<int> takeDue(
+    const std::string& horizon,
+    const std::function<bool(const ScheduledTask&)>& isCurrent);
+};
+
+#endif
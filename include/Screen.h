@@ -0,0 +1,37 @@
+#ifndef SCREEN_H
+#define SCREEN_H
+
+#include <cstddef>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Retained-mode model of the terminal. A frame is a list of lines, each no
+// wider than the terminal; present() compares it with the frame already on
+// screen and rewrites only the rows that differ, using cursor-addressing
+// escapes, in a single write. The cursor is left on the row just below the
+// frame, where the caller reads input.
+//
+// Anything else written to the terminal (prompts that wrap, other screens)
+// leaves the retained frame stale; call invalidate() so the next frame is
+// drawn from scratch.
+class Screen {
+ private:
+  std::ostream& out;
+  std::vector<std::string> shown;
+  int columns;
+  int rows;
+  bool valid;
+
+ public:
+  explicit Screen(std::ostream& out = std::cout);
+
+  // Invalidates the frame if the terminal was resized.
+  void setSize(int width, int height);
+  void invalidate();
+
+  // Returns the number of rows rewritten.
+  size_t present(const std::vector<std::string>& frame);
+};
+
+#endif
@@ -0,0 +1,119 @@
+#ifndef SEARCHINDEX_H
+#define SEARCHINDEX_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Task.h"
+
+struct SearchHit {
+  int taskId;
+  double score;
+};
+
+// Inverted index over the words of task titles and descriptions, for ranked
+// and typo-tolerant search. Each query word is expanded against the
+// vocabulary (exact, prefix, substring, and within a small edit distance
+// found through trigram candidates and checked with Myers' bit-parallel
+// Levenshtein), and a task must match every query word to be returned.
+//
+// Removing a task only invalidates its postings; they are dropped lazily and
+// the lists are compacted once dead postings outnumber live ones.
+class SearchIndex {
+ public:
+  static constexpr size_t DEFAULT_LIMIT = 50;
+
+  static constexpr double TITLE_WEIGHT = 3.0;
+  static constexpr double DESCRIPTION_WEIGHT = 1.0;
+
+  static constexpr double EXACT_SCORE = 1.0;
+  static constexpr double PREFIX_SCORE = 0.8;
+  static constexpr double ONE_EDIT_SCORE = 0.6;
+  static constexpr double SUBSTRING_SCORE = 0.5;
+  static constexpr double TWO_EDIT_SCORE = 0.4;
+
+ private:
+  struct Posting {
+    uint32_t slot;
+    uint32_t stamp;
+    bool inTitle;
+  };
+
+  struct TermMatch {
+    uint32_t term;
+    double score;
+  };
+
+  std::unordered_map<std::string, uint32_t> termIds;
+  std::vector<const std::string*> terms;
+  // Term ids in text order, so prefix matches are a range scan. Terms added
+  // since the last search are merged in by the next one.
+  std::vector<uint32_t> sortedTerms;
+  std::vector<std::vector<Posting>> postings;
+  std::unordered_map<uint32_t, std::vector<uint32_t>> trigramTerms;
+
+  // Per-task state lives in dense slots rather than being indexed by task
+  // id, so memory follows the number of tasks however large their ids are.
+  // Slots are reused after a remove; stamps are never reused, so postings
+  // left behind by the previous occupant stay dead.
+  std::unordered_map<int, uint32_t> slotOf;
+  std::vector<int> slotTasks;
+  std::vector<uint32_t> freeSlots;
+  // Indexed by slot. A posting is live while its stamp matches the slot's
+  // current stamp; 0 means the slot is free.
+  std::vector<uint32_t> stamps;
+  std::vector<uint32_t> postingCounts;
+  uint32_t nextStamp;
+  size_t livePostings;
+  size_t deadPostings;
+  bool built;
+
+  // Scratch buffers reused across calls. The per-query ones are indexed by
+  // slot and reset after each search.
+  std::vector<uint32_t> tokensHit;
+  std::vector<float> bestScore;
+  std::vector<float> totalScore;
+  std::vector<uint32_t> trigramCounts;
+  std::vector<uint32_t> fieldTerms;
+  std::string word;
+
+ public:
+  SearchIndex();
+
+  // TaskManager only maintains the index once a search has built it.
+  bool isBuilt() const {
+    return built;
+  }
+  void setBuilt(bool value) {
+    built = value;
+  }
+
+  void add(const Task& task);
+  void remove(int taskId);
+  void clear();
+
+  // Best matches first, ties broken by id. At most `limit` hits.
+  std::vector<SearchHit> search(const std::string& text, size_t limit);
+
+  // Lowercased runs of letters and digits; bytes >= 0x80 count as letters so
+  // UTF-8 words stay whole.
+  static std::vector<std::string> tokenize(const std::string& text);
+  static size_t editDistance(const std::string& a, const std::string& b);
+
+ private:
+  uint32_t internTerm(const std::string& term);
+  void addField(
+    const std::string& text,
+    uint32_t slot,
+    uint32_t stamp,
+    bool inTitle,
+    uint32_t& added);
+  void sortNewTerms();
+  std::vector<TermMatch> expandToken(const std::string& token);
+  void compact();
+};
+
+#endif
@@ -1,9 +1,12 @@
 #ifndef TASK_H
 #define TASK_H
 
+#include <climits>
 #include <ctime>
 #include <string>
 
+#include "Recurrence.h"
+
 enum class Priority { LOW, MEDIUM, HIGH };
 
 class Task {
@@ -17,8 +20,13 @@ class Task {
   bool completed;
   time_t createdAt;
   time_t completedAt;
+  Recurrence recurrence;
 
  public:
+  // Ids run from 1 to MAX_ID, so the id after the largest still fits in an
+  // int.
+  static constexpr int MAX_ID = INT_MAX - 1;
+
   Task(
     int id,
     const std::string& title,
@@ -26,21 +34,23 @@ class Task {
     const std::string& category = "General",
     const std::string& dueDate = "",
     Priority priority = Priority::MEDIUM);
+  // A copy of `other`, recurrence and timestamps included, under another id.
+  Task(const Task& other, int id);
 
   // Getters
   int getId() const {
     return id;
   }
-  std::string getTitle() const {
+  const std::string& getTitle() const {
     return title;
   }
-  std::string getDescription() const {
+  const std::string& getDescription() const {
     return description;
   }
-  std::string getCategory() const {
+  const std::string& getCategory() const {
     return category;
   }
-  std::string getDueDate() const {
+  const std::string& getDueDate() const {
     return dueDate;
   }
   Priority getPriority() const {
@@ -55,6 +65,9 @@ class Task {
   time_t getCompletedAt() const {
     return completedAt;
   }
+  const Recurrence& getRecurrence() const {
+    return recurrence;
+  }
 
   // Setters
   void setTitle(const std::string& t) {
@@ -72,8 +85,12 @@ class Task {
   void setPriority(Priority p) {
     priority = p;
   }
+  void setRecurrence(const Recurrence& r) {
+    recurrence = r;
+  }
   void markAsCompleted();
   void markAsIncomplete();
+  void restoreState(bool completed, time_t createdAt, time_t completedAt);
 
   std::string priorityToString() const;
   std::string serialize() const;
@@ -1,40 +1,147 @@
 #ifndef TASKMANAGER_H
 #define TASKMANAGER_H
 
+#include <functional>
+#include <map>
 #include <memory>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
+#include "Query.h"
+#include "Scheduler.h"
+#include "SearchIndex.h"
 #include "Task.h"
+#include "TaskSelector.h"
+#include "TaskStatistics.h"
 
 class TaskManager {
  private:
   std::vector<std::unique_ptr<Task>> tasks;
   int nextId;
+  TaskStatistics statistics;
+
+  // Secondary indexes over `tasks`, kept in sync by every mutation.
+  std::unordered_map<int, Task*> idIndex;
+  std::unordered_map<std::string, std::vector<Task*>> categoryIndex;
+  std::multimap<std::string, Task*> dueDateIndex;
+  // Built on first use, then maintained like the indexes above.
+  SearchIndex searchIndex;
+  Scheduler scheduler;
+
+  // Ids changed or deleted since the last save, so FileHandler can merge
+  // with changes other instances made to the same file.
+  std::unordered_set<int> modifiedIds;
+  std::unordered_set<int> deletedIds;
 
  public:
   TaskManager();
 
-  void addTask(
+  // Returns false once every id up to Task::MAX_ID has been handed out.
+  bool addTask(
     const std::string& title,
     const std::string& description = "",
     const std::string& category = "General",
     const std::string& dueDate = "",
-    Priority priority = Priority::MEDIUM);
+    Priority priority = Priority::MEDIUM,
+    const Recurrence& recurrence = Recurrence());
 
+  // Inserts a task with its id, state and timestamps intact. Returns false if
+  // a task with the same id already exists or the id is out of range.
+  bool restoreTask(const Task& task);
+  bool editTask(
+    int id,
+    const std::string& title,
+    const std::string& description,
+    const std::string& category,
+    const std::string& dueDate,
+    Priority priority);
+  bool setTaskRecurrence(int id, const Recurrence& recurrence);
   bool deleteTask(int id);
-  bool toggleTaskCompletion(int id);
+  // Completing a recurring task adds its next occurrence, which takes over
+  // the rule; its id is stored in `nextOccurrenceId` (-1 if none). If no id
+  // is left for it, the completed task keeps the rule.
+  bool toggleTaskCompletion(int id, int* nextOccurrenceId = nullptr);
+  // Mutating a task through this pointer bypasses the statistics; use
+  // editTask()/toggleTaskCompletion() instead.
   Task* getTask(int id);
   std::vector<Task*> getAllTasks();
+  void forEachTask(const std::function<void(const Task&)>& visitor) const;
   std::vector<Task*> getTasksByCategory(const std::string& category);
-  std::vector<Task*> searchTasks(const std::string& keyword);
+  // Ranked, typo-tolerant search over titles and descriptions; best match
+  // first, at most `limit` tasks.
+  std::vector<Task*> searchTasks(
+    const std::string& keyword,
+    size_t limit = SearchIndex::DEFAULT_LIMIT);
   void clearAllTasks();
 
+  // Streams every task matching `query` to `visitor`, which may return false
+  // to stop early and must not add, edit or delete tasks. Returns the number
+  // of tasks visited.
+  size_t runQuery(
+    const Query& query,
+    const std::function<bool(Task*)>& visitor);
+  QueryPlan planQuery(const Query& query) const;
+
+  // Bulk operations resolve the selection once, apply every change in a
+  // single pass and update the indexes once. They return how many tasks
+  // actually changed.
+  size_t setTasksCompleted(const TaskSelector& selection, bool completed);
+  size_t deleteTasks(const TaskSelector& selection);
+  size_t recategorizeTasks(
+    const TaskSelector& selection,
+    const std::string& category);
+  size_t reprioritizeTasks(const TaskSelector& selection, Priority priority);
+
+  // Pending tasks due on or before `horizon` (YYYY-MM-DD) that no earlier
+  // call returned, earliest first. A task comes back only if its due date
+  // changes or it is reopened.
+  std::vector<Task*> takeDueReminders(const std::string& horizon);
+
+  const TaskStatistics& getStatistics() const {
+    return statistics;
+  }
+  TaskStatistics recomputeStatistics() const;
+
   int getNextId() const {
     return nextId;
   }
   void setNextId(int id) {
     nextId = id;
   }
+
+  const std::unordered_set<int>& getModifiedIds() const {
+    return modifiedIds;
+  }
+  const std::unordered_set<int>& getDeletedIds() const {
+    return deletedIds;
+  }
+  void clearChangeLog();
+
+  // Apply changes read back from storage without recording them as local
+  // changes.
+  void applyStoredTask(const Task& task);
+  bool removeStoredTask(int id);
+  // Moves a task to a fresh id (used when another instance saved a different
+  // task under the same id). Returns the new id, or -1 if `id` is unknown or
+  // no ids are left.
+  int renumberTask(int id);
+
+ private:
+  // Category buckets stay in id order. Pass `withCategory` false when an
+  // update keeps the category, so the bucket is left alone.
+  void indexTask(Task* task, bool withCategory = true);
+  void unindexTask(Task* task, bool withCategory = true);
+  void unindexTasks(const std::unordered_set<Task*>& selected);
+  void insertTask(const Task& task);
+  void eraseTask(Task* task);
+  void markModified(int id);
+  void markDeleted(int id);
+  void completeTask(Task* task, int* nextOccurrenceId);
+  void reopenTask(Task* task);
+  void rebuildScheduler();
+  std::vector<Task*> resolveSelection(const TaskSelector& selection);
 };
 
 #endif
@@ -0,0 +1,44 @@
+#ifndef TASKSELECTOR_H
+#define TASKSELECTOR_H
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "Query.h"
+
+// Names the set of tasks a bulk operation applies to: explicit ids, id
+// ranges, or every task matching a query (honouring its sort and limit).
+class TaskSelector {
+ private:
+  // Inclusive id ranges; single ids are stored as [id, id].
+  std::vector<std::pair<int, int>> idRanges;
+  Query query;
+  bool byQuery;
+
+ public:
+  TaskSelector() : byQuery(false) {}
+
+  static TaskSelector ids(const std::vector<int>& ids);
+  static TaskSelector range(int first, int last);
+  static TaskSelector matching(const Query& query);
+
+  // Accepts "3", "1,4,7-9" or a query expression.
+  static bool parse(
+    const std::string& spec,
+    TaskSelector& selector,
+    std::string& error);
+
+  bool isQuery() const {
+    return byQuery;
+  }
+  const Query& getQuery() const {
+    return query;
+  }
+  const std::vector<std::pair<int, int>>& getIdRanges() const {
+    return idRanges;
+  }
+  bool containsId(int id) const;
+};
+
+#endif
@@ -0,0 +1,66 @@
+#ifndef TASKSTATISTICS_H
+#define TASKSTATISTICS_H
+
+#include <map>
+#include <string>
+
+#include "Task.h"
+
+struct CategoryStats {
+  std::string name;
+  int total = 0;
+  int completed = 0;
+};
+
+// Aggregate counters kept in step with the task collection. TaskManager
+// calls add()/remove() around every mutation so reading the totals never
+// requires a pass over the tasks.
+class TaskStatistics {
+ private:
+  int total;
+  int completed;
+  int priorityCounts[3];
+  // Keyed by lowercase category name, matching getTasksByCategory().
+  std::map<std::string, CategoryStats> categories;
+  // Pending tasks per due date (YYYY-MM-DD sorts chronologically).
+  std::map<std::string, int> pendingByDueDate;
+  // Per-day activity derived from createdAt/completedAt.
+  std::map<std::string, int> createdByDay;
+  std::map<std::string, int> completedByDay;
+
+ public:
+  TaskStatistics();
+
+  void add(const Task& task);
+  void remove(const Task& task);
+  void clear();
+
+  int getTotal() const {
+    return total;
+  }
+  int getCompleted() const {
+    return completed;
+  }
+  int getPending() const {
+    return total - completed;
+  }
+  int getPriorityCount(Priority priority) const;
+  double getCompletionRate() const;
+  int countOverdue(const std::string& today) const;
+  int getCreatedOn(const std::string& day) const;
+  int getCompletedOn(const std::string& day) const;
+
+  const std::map<std::string, CategoryStats>& getCategories() const {
+    return categories;
+  }
+
+  bool operator==(const TaskStatistics& other) const;
+  bool operator!=(const TaskStatistics& other) const {
+    return !(*this == other);
+  }
+
+ private:
+  void apply(const Task& task, int delta);
+};
+
+#endif
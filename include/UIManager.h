@@ -5,23 +5,43 @@
 #include <vector>
 
 #include "Task.h"
+#include "TaskStatistics.h"
 
 class UIManager {
  public:
   static void clearScreen();
   static void printHeader(const std::string& title);
-  static void printTask(const Task* task, int displayIndex);
+  // The header as screen rows, each carrying its own colour codes.
+  static const std::vector<std::string>& renderHeader(
+    const std::string& title);
+  // Full details of a task, listed under `number` (its id in every list).
+  static void printTask(const Task* task, int number);
+  // One-line summary of a task, cut to fit `width` columns.
+  static std::string formatTaskRow(const Task* task, int width);
   static void printTaskList(const std::vector<Task*>& tasks);
   static void printMenu();
+  static void printStatistics(const TaskStatistics& stats);
+  static void printReminders(
+    const std::vector<Task*>& tasks,
+    const std::string& today);
   static void printSuccess(const std::string& message);
   static void printError(const std::string& message);
   static void printInfo(const std::string& message);
   static void waitForEnter();
 
+  // 0 when the size cannot be determined (e.g. output is not a terminal).
+  static int getTerminalWidth();
+  static int getTerminalHeight();
+  // Columns taken by UTF-8 text, and the text cut to fit in `width` of them.
+  static size_t displayWidth(const std::string& text);
+  static std::string truncateToWidth(const std::string& text, size_t width);
+  // Task text safe to write to a terminal: control characters and malformed
+  // UTF-8 become U+FFFD.
+  static std::string printable(const std::string& text);
+
  private:
   static std::string getColorCode(Priority priority);
   static std::string formatTimestamp(time_t timestamp);
-  static int getTerminalWidth();
 };
 
 #endif
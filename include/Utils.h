@@ -9,10 +9,20 @@ class Utils {
  public:
   static bool isValidInteger(const std::string& str);
   static int stringToInt(const std::string& str);
+  // Strict base-10 parse: the whole string must be a number that fits.
+  static bool parseInt64(const std::string& str, long long& value);
   static Priority stringToPriority(const std::string& str);
   static std::string trim(const std::string& str);
   static std::string toLowerCase(const std::string& str);
+  static bool equalsIgnoreCase(const std::string& a, const std::string& b);
   static bool isValidDate(const std::string& date);
+  static std::string formatDate(time_t timestamp);
+  static std::string today();
+
+  // Calendar arithmetic on YYYY-MM-DD dates, as days since 1970-01-01.
+  static bool dateToDays(const std::string& date, long& days);
+  static std::string daysToDate(long days);
+  static int daysInMonth(int year, int month);
 };
 
 #endif
@@ -0,0 +1,732 @@
+#include "../include/DataExchange.h"
+
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+#include "../include/Profiler.h"
+#include "../include/Utils.h"
+
+static const char* const FIELD_NAMES[] = {
+  "id",
+  "title",
+  "description",
+  "category",
+  "dueDate",
+  "priority",
+  "completed",
+  "createdAt",
+  "completedAt",
+  "recurrence"};
+static const int FIELD_COUNT = 10;
+
+enum Field {
+  FIELD_ID,
+  FIELD_TITLE,
+  FIELD_DESCRIPTION,
+  FIELD_CATEGORY,
+  FIELD_DUE_DATE,
+  FIELD_PRIORITY,
+  FIELD_COMPLETED,
+  FIELD_CREATED_AT,
+  FIELD_COMPLETED_AT,
+  FIELD_RECURRENCE
+};
+
+static int fieldIndex(const std::string& name) {
+  for (int i = 0; i < FIELD_COUNT; ++i) {
+    if (name == FIELD_NAMES[i])
+      return i;
+  }
+  return -1;
+}
+
+// Builds a task from decoded field values; absent fields keep the same
+// defaults Task's constructor uses.
+static bool buildTask(
+  int id,
+  const std::string* values,
+  const bool* present,
+  Task& task) {
+  if (!present[FIELD_TITLE] || values[FIELD_TITLE].empty())
+    return false;
+
+  std::string category = present[FIELD_CATEGORY] ? values[FIELD_CATEGORY] : "";
+  if (category.empty())
+    category = "General";
+
+  std::string dueDate = present[FIELD_DUE_DATE] ? values[FIELD_DUE_DATE] : "";
+  if (!dueDate.empty() && !Utils::isValidDate(dueDate))
+    return false;
+
+  Priority priority = present[FIELD_PRIORITY]
+                        ? Utils::stringToPriority(values[FIELD_PRIORITY])
+                        : Priority::MEDIUM;
+
+  long long createdAt = 0;
+  long long completedAt = 0;
+  if (
+    present[FIELD_CREATED_AT] &&
+    !Utils::parseInt64(values[FIELD_CREATED_AT], createdAt)) {
+    return false;
+  }
+  if (
+    present[FIELD_COMPLETED_AT] && !values[FIELD_COMPLETED_AT].empty() &&
+    !Utils::parseInt64(values[FIELD_COMPLETED_AT], completedAt)) {
+    return false;
+  }
+
+  Recurrence recurrence;
+  std::string error;
+  if (
+    present[FIELD_RECURRENCE] &&
+    !Recurrence::parse(values[FIELD_RECURRENCE], recurrence, error)) {
+    return false;
+  }
+
+  std::string completedText =
+    present[FIELD_COMPLETED] ? Utils::toLowerCase(values[FIELD_COMPLETED]) : "";
+  bool completed = completedText == "true" || completedText == "1";
+
+  task = Task(
+    id,
+    values[FIELD_TITLE],
+    present[FIELD_DESCRIPTION] ? values[FIELD_DESCRIPTION] : "",
+    category,
+    dueDate,
+    priority);
+  task.restoreState(
+    completed,
+    present[FIELD_CREATED_AT] ? static_cast<time_t>(createdAt)
+                              : task.getCreatedAt(),
+    completed ? static_cast<time_t>(completedAt) : 0);
+  task.setRecurrence(recurrence);
+  return true;
+}
+
+void DataExchange::appendJsonString(
+  std::string& out,
+  const std::string& value) {
+  static const char HEX[] = "0123456789abcdef";
+  out += '"';
+  size_t runStart = 0;
+  for (size_t i = 0; i < value.size(); ++i) {
+    unsigned char c = static_cast<unsigned char>(value[i]);
+    if (c >= 0x20 && c != '"' && c != '\\')
+      continue;
+
+    out.append(value, runStart, i - runStart);
+    runStart = i + 1;
+    switch (c) {
+      case '"':
+        out += "\\\"";
+        break;
+      case '\\':
+        out += "\\\\";
+        break;
+      case '\n':
+        out += "\\n";
+        break;
+      case '\r':
+        out += "\\r";
+        break;
+      case '\t':
+        out += "\\t";
+        break;
+      default:
+        out += "\\u00";
+        out += HEX[c >> 4];
+        out += HEX[c & 0xF];
+    }
+  }
+  out.append(value, runStart, std::string::npos);
+  out += '"';
+}
+
+void DataExchange::appendJsonRecord(std::string& out, const Task& task) {
+  out += "{\"id\":";
+  out += std::to_string(task.getId());
+  out += ",\"title\":";
+  appendJsonString(out, task.getTitle());
+  out += ",\"description\":";
+  appendJsonString(out, task.getDescription());
+  out += ",\"category\":";
+  appendJsonString(out, task.getCategory());
+  out += ",\"dueDate\":";
+  appendJsonString(out, task.getDueDate());
+  out += ",\"priority\":";
+  appendJsonString(out, task.priorityToString());
+  out += ",\"completed\":";
+  out += task.isCompleted() ? "true" : "false";
+  out += ",\"createdAt\":";
+  out += std::to_string(static_cast<long long>(task.getCreatedAt()));
+  out += ",\"completedAt\":";
+  out += std::to_string(static_cast<long long>(task.getCompletedAt()));
+  out += ",\"recurrence\":";
+  appendJsonString(out, task.getRecurrence().toString());
+  out += "}\n";
+}
+
+void DataExchange::appendCsvField(std::string& out, const std::string& value) {
+  if (value.find_first_of(",\"\r\n") == std::string::npos) {
+    out += value;
+    return;
+  }
+
+  out += '"';
+  size_t runStart = 0;
+  size_t quote;
+  while ((quote = value.find('"', runStart)) != std::string::npos) {
+    out.append(value, runStart, quote + 1 - runStart);
+    out += '"';
+    runStart = quote + 1;
+  }
+  out.append(value, runStart, std::string::npos);
+  out += '"';
+}
+
+void DataExchange::appendCsvHeader(std::string& out) {
+  for (int i = 0; i < FIELD_COUNT; ++i) {
+    if (i)
+      out += ',';
+    out += FIELD_NAMES[i];
+  }
+  out += "\r\n";
+}
+
+void DataExchange::appendCsvRecord(std::string& out, const Task& task) {
+  out += std::to_string(task.getId());
+  out += ',';
+  appendCsvField(out, task.getTitle());
+  out += ',';
+  appendCsvField(out, task.getDescription());
+  out += ',';
+  appendCsvField(out, task.getCategory());
+  out += ',';
+  appendCsvField(out, task.getDueDate());
+  out += ',';
+  out += task.priorityToString();
+  out += ',';
+  out += task.isCompleted() ? "true" : "false";
+  out += ',';
+  out += std::to_string(static_cast<long long>(task.getCreatedAt()));
+  out += ',';
+  out += std::to_string(static_cast<long long>(task.getCompletedAt()));
+  out += ',';
+  appendCsvField(out, task.getRecurrence().toString());
+  out += "\r\n";
+}
+
+static void skipSpace(const std::string& s, size_t& pos) {
+  while (pos < s.size() && (s[pos] == ' ' || s[pos] == '\t' || s[pos] == '\r'))
+    ++pos;
+}
+
+static bool parseHex4(const std::string& s, size_t pos, unsigned& value) {
+  if (pos + 4 > s.size())
+    return false;
+  value = 0;
+  for (size_t i = pos; i < pos + 4; ++i) {
+    char c = s[i];
+    value <<= 4;
+    if (c >= '0' && c <= '9')
+      value |= c - '0';
+    else if (c >= 'a' && c <= 'f')
+      value |= c - 'a' + 10;
+    else if (c >= 'A' && c <= 'F')
+      value |= c - 'A' + 10;
+    else
+      return false;
+  }
+  return true;
+}
+
+static void appendUtf8(std::string& out, unsigned codePoint) {
+  if (codePoint < 0x80) {
+    out += static_cast<char>(codePoint);
+  } else if (codePoint < 0x800) {
+    out += static_cast<char>(0xC0 | (codePoint >> 6));
+    out += static_cast<char>(0x80 | (codePoint & 0x3F));
+  } else if (codePoint < 0x10000) {
+    out += static_cast<char>(0xE0 | (codePoint >> 12));
+    out += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+    out += static_cast<char>(0x80 | (codePoint & 0x3F));
+  } else {
+    out += static_cast<char>(0xF0 | (codePoint >> 18));
+    out += static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F));
+    out += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+    out += static_cast<char>(0x80 | (codePoint & 0x3F));
+  }
+}
+
+static bool parseJsonString(
+  const std::string& s,
+  size_t& pos,
+  std::string& out) {
+  if (pos >= s.size() || s[pos] != '"')
+    return false;
+  ++pos;
+  out.clear();
+
+  while (pos < s.size()) {
+    size_t special = s.find_first_of("\"\\", pos);
+    if (special == std::string::npos)
+      return false;
+    out.append(s, pos, special - pos);
+    pos = special;
+
+    if (s[pos] == '"') {
+      ++pos;
+      return true;
+    }
+
+    if (++pos >= s.size())
+      return false;
+    char escape = s[pos++];
+    switch (escape) {
+      case '"':
+      case '\\':
+      case '/':
+        out += escape;
+        break;
+      case 'b':
+        out += '\b';
+        break;
+      case 'f':
+        out += '\f';
+        break;
+      case 'n':
+        out += '\n';
+        break;
+      case 'r':
+        out += '\r';
+        break;
+      case 't':
+        out += '\t';
+        break;
+      case 'u': {
+        unsigned codePoint;
+        if (!parseHex4(s, pos, codePoint))
+          return false;
+        pos += 4;
+        if (codePoint >= 0xD800 && codePoint <= 0xDBFF) {
+          unsigned low;
+          if (
+            pos + 6 > s.size() || s[pos] != '\\' || s[pos + 1] != 'u' ||
+            !parseHex4(s, pos + 2, low) || low < 0xDC00 || low > 0xDFFF) {
+            return false;
+          }
+          pos += 6;
+          codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (low - 0xDC00);
+        } else if (codePoint >= 0xDC00 && codePoint <= 0xDFFF) {
+          return false;
+        }
+        appendUtf8(out, codePoint);
+        break;
+      }
+      default:
+        return false;
+    }
+  }
+  return false;
+}
+
+// Numbers and literals are returned as their source text.
+static bool parseJsonScalar(
+  const std::string& s,
+  size_t& pos,
+  std::string& out) {
+  size_t start = pos;
+  while (pos < s.size() && s[pos] != ',' && s[pos] != '}' && s[pos] != ' ' &&
+         s[pos] != '\t' && s[pos] != '\r') {
+    ++pos;
+  }
+  out.assign(s, start, pos - start);
+  return !out.empty() && out != "null";
+}
+
+// Skips a nested array or object; unknown keys may carry either.
+static bool skipJsonContainer(const std::string& s, size_t& pos) {
+  std::string scratch;
+  int depth = 0;
+  while (pos < s.size()) {
+    char c = s[pos];
+    if (c == '"') {
+      if (!parseJsonString(s, pos, scratch))
+        return false;
+      continue;
+    }
+    if (c == '[' || c == '{') {
+      ++depth;
+    } else if (c == ']' || c == '}') {
+      if (--depth == 0) {
+        ++pos;
+        return true;
+      }
+    }
+    ++pos;
+  }
+  return false;
+}
+
+bool DataExchange::parseJsonRecord(const std::string& record, Task& task) {
+  std::string values[FIELD_COUNT];
+  bool present[FIELD_COUNT] = {};
+  std::string key;
+  std::string value;
+
+  size_t pos = 0;
+  skipSpace(record, pos);
+  if (pos >= record.size() || record[pos] != '{')
+    return false;
+  ++pos;
+  skipSpace(record, pos);
+
+  if (pos < record.size() && record[pos] == '}') {
+    ++pos;
+  } else {
+    while (true) {
+      skipSpace(record, pos);
+      if (!parseJsonString(record, pos, key))
+        return false;
+      skipSpace(record, pos);
+      if (pos >= record.size() || record[pos] != ':')
+        return false;
+      ++pos;
+      skipSpace(record, pos);
+
+      bool hasValue = false;
+      if (pos < record.size() && record[pos] == '"') {
+        if (!parseJsonString(record, pos, value))
+          return false;
+        hasValue = true;
+      } else if (
+        pos < record.size() && (record[pos] == '[' || record[pos] == '{')) {
+        if (!skipJsonContainer(record, pos))
+          return false;
+      } else {
+        hasValue = parseJsonScalar(record, pos, value);
+      }
+
+      int index = fieldIndex(key);
+      if (index >= 0 && hasValue) {
+        values[index] = value;
+        present[index] = true;
+      }
+
+      skipSpace(record, pos);
+      if (pos >= record.size())
+        return false;
+      if (record[pos] == '}') {
+        ++pos;
+        break;
+      }
+      if (record[pos] != ',')
+        return false;
+      ++pos;
+    }
+  }
+
+  skipSpace(record, pos);
+  if (pos != record.size())
+    return false;
+
+  return buildTask(task.getId(), values, present, task);
+}
+
+static bool parseCsvRecord(
+  const std::string& record,
+  std::vector<std::string>& fields) {
+  size_t count = 0;
+  size_t pos = 0;
+
+  while (true) {
+    if (count == fields.size())
+      fields.emplace_back();
+    std::string& field = fields[count++];
+    field.clear();
+
+    if (pos < record.size() && record[pos] == '"') {
+      ++pos;
+      while (true) {
+        size_t quote = record.find('"', pos);
+        if (quote == std::string::npos)
+          return false;
+        field.append(record, pos, quote - pos);
+        pos = quote + 1;
+        if (pos < record.size() && record[pos] == '"') {
+          field += '"';
+          ++pos;
+        } else {
+          break;
+        }
+      }
+      if (pos < record.size() && record[pos] != ',')
+        return false;
+    } else {
+      size_t comma = record.find(',', pos);
+      size_t end = comma == std::string::npos ? record.size() : comma;
+      field.assign(record, pos, end - pos);
+      pos = end;
+    }
+
+    if (pos >= record.size())
+      break;
+    ++pos;  // skip the comma
+  }
+
+  fields.resize(count);
+  return true;
+}
+
+// Splits a byte stream into records, reading it CHUNK_SIZE bytes at a time.
+// CSV records may span lines inside quoted fields; JSON Lines never do.
+class RecordReader {
+ private:
+  // Where the scan is within a CSV record. As in parseCsvRecord(), a quote
+  // only opens a quoted field at the start of the field, and inside one a
+  // doubled quote stands for a literal quote.
+  enum class CsvState { FIELD_START, UNQUOTED, QUOTED, QUOTE_IN_QUOTED };
+
+  std::istream& in;
+  ExchangeFormat format;
+  std::vector<char> chunk;
+  size_t pos;
+  size_t length;
+  CsvState state;
+  bool oversized;
+
+  // Returns the end of the record in [cursor, end), or `end` if it goes on.
+  const char* scanCsv(const char* cursor, const char* end) {
+    for (; cursor < end; ++cursor) {
+      char c = *cursor;
+      switch (state) {
+        case CsvState::FIELD_START:
+          if (c == '"')
+            state = CsvState::QUOTED;
+          else if (c == '\n')
+            return cursor;
+          else if (c != ',')
+            state = CsvState::UNQUOTED;
+          break;
+        case CsvState::UNQUOTED:
+          if (c == ',')
+            state = CsvState::FIELD_START;
+          else if (c == '\n')
+            return cursor;
+          break;
+        case CsvState::QUOTED:
+          if (c == '"')
+            state = CsvState::QUOTE_IN_QUOTED;
+          break;
+        case CsvState::QUOTE_IN_QUOTED:
+          if (c == '"')
+            state = CsvState::QUOTED;
+          else if (c == ',')
+            state = CsvState::FIELD_START;
+          else if (c == '\n')
+            return cursor;
+          else
+            state = CsvState::UNQUOTED;  // malformed; the parser rejects it
+          break;
+      }
+    }
+    return end;
+  }
+
+ public:
+  RecordReader(std::istream& in, ExchangeFormat format)
+      : in(in),
+        format(format),
+        chunk(DataExchange::CHUNK_SIZE),
+        pos(0),
+        length(0),
+        state(CsvState::FIELD_START),
+        oversized(false) {}
+
+  // True if the last record was cut off at MAX_RECORD_SIZE.
+  bool wasOversized() const {
+    return oversized;
+  }
+
+  bool next(std::string& record) {
+    record.clear();
+    oversized = false;
+    state = CsvState::FIELD_START;
+    bool consumed = false;
+
+    while (true) {
+      if (pos == length) {
+        in.read(chunk.data(), chunk.size());
+        length = static_cast<size_t>(in.gcount());
+        pos = 0;
+        if (length == 0)
+          return consumed;
+      }
+      consumed = true;
+
+      const char* start = chunk.data() + pos;
+      const char* end = chunk.data() + length;
+      const char* cursor;
+      if (format == ExchangeFormat::JSONL || oversized) {
+        // Past the limit, quotes no longer count: skip to the next line.
+        const void* newline = std::memchr(start, '\n', end - start);
+        cursor = newline ? static_cast<const char*>(newline) : end;
+      } else {
+        cursor = scanCsv(start, end);
+      }
+
+      if (!oversized) {
+        size_t room = DataExchange::MAX_RECORD_SIZE - record.size();
+        if (static_cast<size_t>(cursor - start) > room) {
+          oversized = true;
+          record.clear();
+          // Drop the record and resume after the next line break in this
+          // chunk, ignoring quotes.
+          const void* newline = std::memchr(start, '\n', end - start);
+          cursor = newline ? static_cast<const char*>(newline) : end;
+        } else {
+          record.append(start, cursor);
+        }
+      }
+
+      pos = cursor - chunk.data();
+      if (cursor < end) {
+        ++pos;
+        if (!record.empty() && record.back() == '\r')
+          record.pop_back();
+        return true;
+      }
+    }
+  }
+};
+
+bool DataExchange::formatFromPath(
+  const std::string& path,
+  ExchangeFormat& format) {
+  size_t dot = path.find_last_of('.');
+  if (dot == std::string::npos)
+    return false;
+
+  std::string extension = Utils::toLowerCase(path.substr(dot + 1));
+  if (extension == "jsonl" || extension == "ndjson") {
+    format = ExchangeFormat::JSONL;
+    return true;
+  }
+  if (extension == "csv") {
+    format = ExchangeFormat::CSV;
+    return true;
+  }
+  return false;
+}
+
+ExchangeResult DataExchange::exportTasks(
+  const TaskManager& manager,
+  const std::string& path,
+  ExchangeFormat format) {
+  PROFILE_SCOPE("DataExchange::exportTasks");
+  ExchangeResult result;
+
+  std::ofstream file(path, std::ios::binary | std::ios::trunc);
+  if (!file.is_open())
+    return result;
+
+  std::string buffer;
+  buffer.reserve(CHUNK_SIZE);
+  if (format == ExchangeFormat::CSV)
+    appendCsvHeader(buffer);
+
+  size_t inBatch = 0;
+  manager.forEachTask([&](const Task& task) {
+    if (format == ExchangeFormat::JSONL) {
+      appendJsonRecord(buffer, task);
+    } else {
+      appendCsvRecord(buffer, task);
+    }
+    result.processed++;
+
+    if (++inBatch == BATCH_SIZE || buffer.size() >= CHUNK_SIZE) {
+      file.write(buffer.data(), buffer.size());
+      buffer.clear();
+      inBatch = 0;
+    }
+  });
+
+  file.write(buffer.data(), buffer.size());
+  file.close();
+  result.success = !file.fail();
+  PROFILE_COUNT("tasks.exported", result.processed);
+  return result;
+}
+
+ExchangeResult DataExchange::importTasks(
+  TaskManager& manager,
+  const std::string& path,
+  ExchangeFormat format) {
+  PROFILE_SCOPE("DataExchange::importTasks");
+  ExchangeResult result;
+
+  std::ifstream file(path, std::ios::binary);
+  if (!file.is_open())
+    return result;
+
+  RecordReader reader(file, format);
+  std::string record;
+  std::vector<std::string> fields;
+  int columns[FIELD_COUNT];
+  bool haveHeader = format != ExchangeFormat::CSV;
+
+  while (reader.next(record)) {
+    if (reader.wasOversized()) {
+      result.rejected++;
+      continue;
+    }
+    if (record.empty())
+      continue;
+
+    Task task(manager.getNextId(), "");
+    bool parsed = false;
+
+    if (format == ExchangeFormat::JSONL) {
+      parsed = parseJsonRecord(record, task);
+    } else if (parseCsvRecord(record, fields)) {
+      if (!haveHeader) {
+        // The header maps column positions to fields, so column order and
+        // extra columns are tolerated.
+        for (int& column : columns)
+          column = -1;
+        for (size_t i = 0; i < fields.size(); ++i) {
+          int index = fieldIndex(Utils::trim(fields[i]));
+          if (index >= 0)
+            columns[index] = static_cast<int>(i);
+        }
+        if (columns[FIELD_TITLE] < 0)
+          return result;
+        haveHeader = true;
+        continue;
+      }
+
+      std::string values[FIELD_COUNT];
+      bool present[FIELD_COUNT] = {};
+      for (int i = 0; i < FIELD_COUNT; ++i) {
+        size_t column = static_cast<size_t>(columns[i]);
+        if (columns[i] >= 0 && column < fields.size()) {
+          values[i].swap(fields[column]);
+          present[i] = true;
+        }
+      }
+      parsed = buildTask(task.getId(), values, present, task);
+    }
+
+    if (parsed && manager.restoreTask(task)) {
+      result.processed++;
+    } else {
+      result.rejected++;
+    }
+  }
+
+  result.success = !file.bad();
+  PROFILE_COUNT("tasks.imported", result.processed);
+  PROFILE_COUNT("tasks.rejected", result.rejected);
+  return result;
+}
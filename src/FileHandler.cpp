@@ -2,89 +2,412 @@
 
 #include <sys/stat.h>
 
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
 #include <fstream>
+#include <stdexcept>
+#include <unordered_set>
+#include <vector>
+
+#include "../include/Profiler.h"
+#include "../include/Utils.h"
 
 #ifdef _WIN32
 #include <direct.h>
+#include <windows.h>
 #define mkdir _mkdir
 #else
+#include <fcntl.h>
+#include <sys/file.h>
 #include <sys/types.h>
+#include <unistd.h>
+#endif
+
+// RAII advisory lock, shared for readers and exclusive for writers. It lives
+// on a sidecar file because saves replace the data file itself. Locking is
+// best effort: if the lock file cannot be opened the caller carries on
+// unlocked, as before locking existed.
+class FileLock {
+ private:
+#ifdef _WIN32
+  HANDLE handle;
+  OVERLAPPED overlapped;
+#else
+  int fd;
 #endif
+  bool locked;
 
-FileHandler::FileHandler(const std::string& filename) : filename(filename) {
+ public:
+  FileLock(const std::string& path, bool exclusive) : locked(false) {
+#ifdef _WIN32
+    overlapped = {};
+    handle = CreateFileA(
+      path.c_str(),
+      GENERIC_READ | GENERIC_WRITE,
+      FILE_SHARE_READ | FILE_SHARE_WRITE,
+      nullptr,
+      OPEN_ALWAYS,
+      FILE_ATTRIBUTE_NORMAL,
+      nullptr);
+    if (handle != INVALID_HANDLE_VALUE) {
+      locked = LockFileEx(
+        handle,
+        exclusive ? LOCKFILE_EXCLUSIVE_LOCK : 0,
+        0,
+        MAXDWORD,
+        MAXDWORD,
+        &overlapped);
+    }
+#else
+    fd = open(path.c_str(), O_RDWR | O_CREAT, 0644);
+    if (fd >= 0) {
+      int result;
+      do {
+        result = flock(fd, exclusive ? LOCK_EX : LOCK_SH);
+      } while (result != 0 && errno == EINTR);
+      locked = result == 0;
+    }
+#endif
+  }
+
+  ~FileLock() {
+#ifdef _WIN32
+    if (handle != INVALID_HANDLE_VALUE) {
+      if (locked) {
+        UnlockFileEx(handle, 0, MAXDWORD, MAXDWORD, &overlapped);
+      }
+      CloseHandle(handle);
+    }
+#else
+    if (fd >= 0) {
+      close(fd);  // releases the flock
+    }
+#endif
+  }
+
+  FileLock(const FileLock&) = delete;
+  FileLock& operator=(const FileLock&) = delete;
+
+  bool isLocked() const {
+    return locked;
+  }
+};
+
+FileHandler::FileHandler(const std::string& filename)
+    : filename(filename),
+      lockFilename(filename + ".lock"),
+      rejectedFilename(filename + ".rejected"),
+      rejectedRecords(0),
+      generation(0) {
   ensureDataDirectory();
 }
 
+// Creates the directory the data file lives in (by default "data").
 void FileHandler::ensureDataDirectory() {
+  size_t slash = filename.find_last_of("/\\");
+  if (slash == std::string::npos || slash == 0)
+    return;
+  std::string directory = filename.substr(0, slash);
+
   struct stat info;
-  if (stat("data", &info) != 0) {
+  if (stat(directory.c_str(), &info) != 0) {
 #ifdef _WIN32
-    mkdir("data");
+    mkdir(directory.c_str());
 #else
-    mkdir("data", 0755);
+    mkdir(directory.c_str(), 0755);
 #endif
   }
 }
 
-bool FileHandler::saveTasks(TaskManager& manager) {
-  std::ofstream file(filename);
-  if (!file.is_open()) {
-    return false;
+FileSignature FileHandler::readSignature() const {
+  FileSignature current;
+  struct stat info;
+  if (stat(filename.c_str(), &info) == 0) {
+    current.exists = true;
+    current.inode = static_cast<unsigned long long>(info.st_ino);
+    current.size = static_cast<long long>(info.st_size);
+    current.modifiedAt = info.st_mtime;
+    current.changedAt = info.st_ctime;
+#if defined(__APPLE__)
+    current.modifiedNanos = info.st_mtimespec.tv_nsec;
+    current.changedNanos = info.st_ctimespec.tv_nsec;
+#elif !defined(_WIN32)
+    current.modifiedNanos = info.st_mtim.tv_nsec;
+    current.changedNanos = info.st_ctim.tv_nsec;
+#endif
   }
+  return current;
+}
 
-  file << manager.getNextId() << std::endl;
+// The header is "<nextId>|<generation>" and every record is a serialized
+// task followed by "|<version>". Files written before versioning have a bare
+// "<nextId>" header and unversioned records, which load as version 0.
+//
+// Records whose version matches what we already hold are skipped without
+// being parsed. For the rest, local unsaved changes win; a record that
+// collides with a task created locally under the same id moves the local
+// task to a fresh id first. Known records missing from the file were
+// deleted elsewhere and are dropped unless modified locally.
+bool FileHandler::mergeFromFile(TaskManager& manager, bool force) {
+  PROFILE_SCOPE("FileHandler::mergeFromFile");
+  FileSignature current = readSignature();
 
-  for (Task* task : manager.getAllTasks()) {
-    file << task->serialize() << std::endl;
+  std::ifstream file(filename);
+  std::string line;
+  if (!file.is_open() || !std::getline(file, line)) {
+    signature = current;
+    return false;
   }
 
-  file.close();
-  return true;
-}
+  size_t headerBar = line.find('|');
+  bool versioned = headerBar != std::string::npos;
+  unsigned long long fileGeneration =
+    versioned ? std::strtoull(line.c_str() + headerBar + 1, nullptr, 10) : 0;
 
-bool FileHandler::loadTasks(TaskManager& manager) {
-  std::ifstream file(filename);
-  if (!file.is_open()) {
+  if (!force && fileGeneration == generation) {
+    signature = current;
     return false;
   }
 
-  std::string line;
-  if (std::getline(file, line)) {
-    try {
-      manager.setNextId(std::stoi(line));
-    } catch (...) {
-      manager.setNextId(1);
-    }
+  // On a bad header keep our own counter; ids found in the records still
+  // advance it.
+  long long fileNextId;
+  if (
+    Utils::parseInt64(line.substr(0, headerBar), fileNextId) &&
+    fileNextId > manager.getNextId() && fileNextId <= Task::MAX_ID + 1) {
+    manager.setNextId(static_cast<int>(fileNextId));
   }
 
+  const std::unordered_set<int>& modified = manager.getModifiedIds();
+  const std::unordered_set<int>& deleted = manager.getDeletedIds();
+  bool trackSeen = !recordVersions.empty();
+  std::unordered_set<int> seen;
+  std::vector<std::string> rejected;
+  bool changed = false;
+
   while (std::getline(file, line)) {
+    if (line.empty())
+      continue;
+
+    size_t firstBar = line.find('|');
+    char* end = nullptr;
+    long id = std::strtol(line.c_str(), &end, 10);
+    if (
+      firstBar == std::string::npos || end != line.c_str() + firstBar ||
+      id < 1 || id > Task::MAX_ID) {
+      PROFILE_COUNT("tasks.rejected", 1);
+      rejected.push_back(line);
+      continue;
+    }
+
+    unsigned long long version = 0;
+    size_t recordEnd = line.size();
+    if (versioned) {
+      recordEnd = line.rfind('|');
+      version = std::strtoull(line.c_str() + recordEnd + 1, nullptr, 10);
+    }
+
+    if (trackSeen) {
+      seen.insert(static_cast<int>(id));
+    }
+
+    auto known = recordVersions.find(static_cast<int>(id));
+    if (known != recordVersions.end() && known->second == version) {
+      continue;
+    }
+
+    bool localModified = modified.count(static_cast<int>(id)) > 0;
+    if (
+      known != recordVersions.end() &&
+      (localModified || deleted.count(static_cast<int>(id)))) {
+      known->second = version;
+      continue;
+    }
+    if (known == recordVersions.end() && localModified) {
+      manager.renumberTask(static_cast<int>(id));
+    }
+
     try {
-      Task task = Task::deserialize(line);
-      manager.addTask(
-        task.getTitle(),
-        task.getDescription(),
-        task.getCategory(),
-        task.getDueDate(),
-        task.getPriority());
-
-      Task* loadedTask = manager.getTask(task.getId());
-      if (loadedTask && task.isCompleted()) {
-        loadedTask->markAsCompleted();
+      Task task = Task::deserialize(line.substr(0, recordEnd));
+      if (task.getId() != id) {
+        throw std::runtime_error("Mismatched task id");
       }
-    } catch (...) {
-      continue;
+      manager.applyStoredTask(task);
+      recordVersions[task.getId()] = version;
+      changed = true;
+      PROFILE_COUNT("tasks.loaded", 1);
+    } catch (const std::exception&) {
+      // invalid_argument/out_of_range from the numeric fields, or the
+      // runtime_error deserialize() throws for malformed records.
+      PROFILE_COUNT("tasks.rejected", 1);
+      rejected.push_back(line);
     }
   }
 
+  rejectedRecords = rejected.size();
+  if (!rejected.empty()) {
+    keepRejected(rejected);
+  }
+
+  if (trackSeen) {
+    for (auto it = recordVersions.begin(); it != recordVersions.end();) {
+      if (seen.count(it->first)) {
+        ++it;
+        continue;
+      }
+      if (!modified.count(it->first) && manager.removeStoredTask(it->first)) {
+        changed = true;
+      }
+      it = recordVersions.erase(it);
+    }
+  }
+
+  generation = fileGeneration;
+  signature = current;
+  return changed;
+}
+
+void FileHandler::keepRejected(const std::vector<std::string>& lines) {
+  // The bad lines stay in the data file until the next save, so later loads
+  // and refreshes see them again; copy each one only once.
+  std::unordered_set<std::string> kept;
+  std::ifstream existing(rejectedFilename);
+  std::string line;
+  while (std::getline(existing, line)) {
+    kept.insert(line);
+  }
+
+  std::ofstream file(rejectedFilename, std::ofstream::app);
+  for (const std::string& rejected : lines) {
+    if (kept.insert(rejected).second) {
+      file << rejected << "\n";
+    }
+  }
+}
+
+bool FileHandler::refresh(TaskManager& manager) {
+  if (readSignature() == signature) {
+    return false;
+  }
+
+  FileLock lock(lockFilename, false);
+  return mergeFromFile(manager, false);
+}
+
+bool FileHandler::saveTasks(TaskManager& manager) {
+  PROFILE_SCOPE("FileHandler::saveTasks");
+  FileLock lock(lockFilename, true);
+
+  // Merge in whatever was saved since we last read the file. This reads only
+  // the header when its generation is still ours; the stat signature is not
+  // trusted here because an overwrite in the same second can look unchanged.
+  mergeFromFile(manager, false);
+
+  // Write a sibling file and rename it over the original, so readers never
+  // see a half-written store and a crash mid-save loses nothing.
+  std::string tempFilename = filename + ".tmp";
+  std::ofstream file(tempFilename, std::ofstream::trunc);
+  if (!file.is_open()) {
+    return false;
+  }
+
+  unsigned long long newGeneration = generation + 1;
+  file << manager.getNextId() << "|" << newGeneration << "\n";
+
+  const std::unordered_set<int>& modified = manager.getModifiedIds();
+  std::vector<int> bumped;
+  size_t saved = 0;
+  manager.forEachTask([&](const Task& task) {
+    auto known = recordVersions.find(task.getId());
+    unsigned long long version = newGeneration;
+    if (known != recordVersions.end() && !modified.count(task.getId())) {
+      version = known->second;
+    } else {
+      bumped.push_back(task.getId());
+    }
+    file << task.serialize() << "|" << version << "\n";
+    saved++;
+  });
+
   file.close();
+  if (file.fail()) {
+    std::remove(tempFilename.c_str());
+    return false;
+  }
+
+#ifdef _WIN32
+  bool replaced = MoveFileExA(
+    tempFilename.c_str(), filename.c_str(), MOVEFILE_REPLACE_EXISTING);
+#else
+  bool replaced = std::rename(tempFilename.c_str(), filename.c_str()) == 0;
+#endif
+  if (!replaced) {
+    std::remove(tempFilename.c_str());
+    return false;
+  }
+
+  for (int id : bumped) {
+    recordVersions[id] = newGeneration;
+  }
+  for (int id : manager.getDeletedIds()) {
+    if (!manager.getTask(id)) {
+      recordVersions.erase(id);
+    }
+  }
+  generation = newGeneration;
+  signature = readSignature();
+  manager.clearChangeLog();
+  PROFILE_COUNT("tasks.saved", saved);
   return true;
 }
 
+bool FileHandler::loadTasks(TaskManager& manager) {
+  PROFILE_SCOPE("FileHandler::loadTasks");
+  FileLock lock(lockFilename, false);
+
+  generation = 0;
+  recordVersions.clear();
+  mergeFromFile(manager, true);
+  manager.clearChangeLog();
+  return signature.exists;
+}
+
 bool FileHandler::clearFile() {
+  FileLock lock(lockFilename, true);
+
+  // Another instance may have saved since we last looked; the new generation
+  // must be above whatever is on disk.
+  unsigned long long newGeneration = generation;
+  std::string header;
+  std::ifstream current(filename);
+  if (current.is_open() && std::getline(current, header)) {
+    size_t bar = header.find('|');
+    if (bar != std::string::npos) {
+      unsigned long long onDisk =
+        std::strtoull(header.c_str() + bar + 1, nullptr, 10);
+      if (onDisk > newGeneration) {
+        newGeneration = onDisk;
+      }
+    }
+  }
+  current.close();
+  newGeneration++;
+
+  // An empty store with a new generation, so other instances notice the
+  // clear and drop their copies on their next refresh.
   std::ofstream file(filename, std::ofstream::trunc);
   if (!file.is_open()) {
     return false;
   }
+  file << 1 << "|" << newGeneration << "\n";
   file.close();
+  if (file.fail()) {
+    return false;
+  }
+
+  generation = newGeneration;
+  recordVersions.clear();
+  signature = readSignature();
   return true;
 }
@@ -0,0 +1,162 @@
+#include "../include/Profiler.h"
+
+#include <iomanip>
+#include <sstream>
+
+Profiler::ScopedTimer::~ScopedTimer() {
+  auto elapsed = std::chrono::steady_clock::now() - start;
+  Profiler::record(
+    metric,
+    static_cast<uint64_t>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()));
+}
+
+uint64_t Profiler::Metric::percentileNanos(double fraction) const {
+  if (count == 0)
+    return 0;
+
+  uint64_t target = static_cast<uint64_t>(fraction * count);
+  if (target >= count)
+    target = count - 1;
+
+  uint64_t seen = 0;
+  for (int i = 0; i < HISTOGRAM_BUCKETS; ++i) {
+    seen += buckets[i];
+    if (seen > target) {
+      // Report the bucket's upper bound, clamped to the observed range.
+      uint64_t upper = uint64_t(1) << (i + 1);
+      return upper < maxNanos ? upper : maxNanos;
+    }
+  }
+  return maxNanos;
+}
+
+std::map<std::string, Profiler::Metric>& Profiler::metrics() {
+  static std::map<std::string, Metric> registry;
+  return registry;
+}
+
+std::map<std::string, uint64_t>& Profiler::counters() {
+  static std::map<std::string, uint64_t> registry;
+  return registry;
+}
+
+Profiler::Metric& Profiler::metric(const std::string& name) {
+  return metrics()[name];
+}
+
+uint64_t& Profiler::counter(const std::string& name) {
+  return counters()[name];
+}
+
+void Profiler::record(Metric& metric, uint64_t nanos) {
+  metric.count++;
+  metric.totalNanos += nanos;
+  if (nanos < metric.minNanos)
+    metric.minNanos = nanos;
+  if (nanos > metric.maxNanos)
+    metric.maxNanos = nanos;
+
+  int bucket = 0;
+  while (bucket < HISTOGRAM_BUCKETS - 1 && (nanos >> (bucket + 1)) != 0) {
+    bucket++;
+  }
+  metric.buckets[bucket]++;
+}
+
+void Profiler::reset() {
+  // Entries are kept so references cached by PROFILE_* call sites stay valid.
+  for (auto& entry : metrics()) {
+    entry.second = Metric();
+  }
+  for (auto& entry : counters()) {
+    entry.second = 0;
+  }
+}
+
+static std::string formatNanos(uint64_t nanos) {
+  std::ostringstream ss;
+  ss << std::fixed << std::setprecision(1);
+  if (nanos >= 1000000000ULL) {
+    ss << nanos / 1e9 << "s";
+  } else if (nanos >= 1000000ULL) {
+    ss << nanos / 1e6 << "ms";
+  } else if (nanos >= 1000ULL) {
+    ss << nanos / 1e3 << "us";
+  } else {
+    ss << nanos << "ns";
+  }
+  return ss.str();
+}
+
+void Profiler::printReport(std::ostream& out) {
+  if (!isEnabled()) {
+    out << "Profiling is disabled in this build "
+           "(configure with -DTODO_ENABLE_PROFILING=ON).\n";
+    return;
+  }
+
+  if (metrics().empty() && counters().empty()) {
+    out << "No operations recorded yet.\n";
+    return;
+  }
+
+  out << std::left << std::setw(32) << "Operation" << std::right
+      << std::setw(8) << "Calls" << std::setw(11) << "Mean"
+      << std::setw(11) << "p50" << std::setw(11) << "p99" << std::setw(11)
+      << "Max" << "\n";
+
+  for (const auto& entry : metrics()) {
+    const Metric& m = entry.second;
+    if (m.count == 0)
+      continue;
+    out << std::left << std::setw(32) << entry.first << std::right
+        << std::setw(8) << m.count << std::setw(11)
+        << formatNanos(m.totalNanos / m.count) << std::setw(11)
+        << formatNanos(m.percentileNanos(0.5)) << std::setw(11)
+        << formatNanos(m.percentileNanos(0.99)) << std::setw(11)
+        << formatNanos(m.maxNanos) << "\n";
+  }
+
+  if (!counters().empty()) {
+    out << "\n";
+    for (const auto& entry : counters()) {
+      out << std::left << std::setw(32) << entry.first << std::right
+          << std::setw(8) << entry.second << "\n";
+    }
+  }
+}
+
+void Profiler::dumpJson(std::ostream& out) {
+  out << "{\"enabled\":" << (isEnabled() ? "true" : "false")
+      << ",\"timers\":{";
+
+  bool first = true;
+  for (const auto& entry : metrics()) {
+    const Metric& m = entry.second;
+    if (!first)
+      out << ",";
+    first = false;
+
+    out << "\"" << entry.first << "\":{\"count\":" << m.count
+        << ",\"total_ns\":" << m.totalNanos
+        << ",\"min_ns\":" << (m.count ? m.minNanos : 0)
+        << ",\"max_ns\":" << m.maxNanos
+        << ",\"p50_ns\":" << m.percentileNanos(0.5)
+        << ",\"p99_ns\":" << m.percentileNanos(0.99) << ",\"histogram\":[";
+    for (int i = 0; i < HISTOGRAM_BUCKETS; ++i) {
+      out << (i ? "," : "") << m.buckets[i];
+    }
+    out << "]}";
+  }
+
+  out << "},\"counters\":{";
+  first = true;
+  for (const auto& entry : counters()) {
+    if (!first)
+      out << ",";
+    first = false;
+    out << "\"" << entry.first << "\":" << entry.second;
+  }
+  out << "}}\n";
+}
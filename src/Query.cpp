@@ -0,0 +1,332 @@
+#include "../include/Query.h"
+
+#include <algorithm>
+#include <cctype>
+#include <vector>
+
+#include "../include/Utils.h"
+
+static bool containsIgnoreCase(
+  const std::string& haystack,
+  const std::string& lowerNeedle) {
+  auto it = std::search(
+    haystack.begin(),
+    haystack.end(),
+    lowerNeedle.begin(),
+    lowerNeedle.end(),
+    [](char a, char b) {
+      return std::tolower(static_cast<unsigned char>(a)) == b;
+    });
+  return it != haystack.end();
+}
+
+bool Query::containsText(const Task& task, const std::string& lowerNeedle) {
+  return containsIgnoreCase(task.getTitle(), lowerNeedle) ||
+         containsIgnoreCase(task.getDescription(), lowerNeedle);
+}
+
+bool Query::matchesDueDate(const std::string& dueDate) const {
+  if (!hasDueRange())
+    return true;
+  if (dueDate.empty())
+    return false;
+
+  if (dueFrom) {
+    if (dueFromInclusive ? dueDate < *dueFrom : dueDate <= *dueFrom)
+      return false;
+  }
+  if (dueTo) {
+    if (dueToInclusive ? dueDate > *dueTo : dueDate >= *dueTo)
+      return false;
+  }
+  return true;
+}
+
+bool Query::matchesFields(const Task& task) const {
+  if (completed && task.isCompleted() != *completed)
+    return false;
+  if (minPriority && task.getPriority() < *minPriority)
+    return false;
+  if (maxPriority && task.getPriority() > *maxPriority)
+    return false;
+  if (category && !Utils::equalsIgnoreCase(task.getCategory(), *category))
+    return false;
+  return matchesDueDate(task.getDueDate());
+}
+
+bool Query::matches(const Task& task) const {
+  return matchesFields(task) &&
+         (!text || containsText(task, Utils::toLowerCase(*text)));
+}
+
+bool Query::comesBefore(const Task& a, const Task& b) const {
+  const Task& x = descending ? b : a;
+  const Task& y = descending ? a : b;
+
+  switch (sortKey) {
+    case SortKey::TITLE: {
+      int order = Utils::toLowerCase(x.getTitle())
+                    .compare(Utils::toLowerCase(y.getTitle()));
+      if (order != 0)
+        return order < 0;
+      break;
+    }
+    case SortKey::DUE_DATE:
+      // Tasks without a due date sort after every dated task.
+      if (a.getDueDate().empty() != b.getDueDate().empty())
+        return b.getDueDate().empty();
+      if (x.getDueDate() != y.getDueDate())
+        return x.getDueDate() < y.getDueDate();
+      break;
+    case SortKey::PRIORITY:
+      if (x.getPriority() != y.getPriority())
+        return x.getPriority() < y.getPriority();
+      break;
+    case SortKey::CREATED:
+      if (x.getCreatedAt() != y.getCreatedAt())
+        return x.getCreatedAt() < y.getCreatedAt();
+      break;
+    case SortKey::ID:
+    case SortKey::NONE:
+      break;
+  }
+  return x.getId() < y.getId();
+}
+
+// Splits on whitespace; double quotes group words and are removed.
+static bool tokenize(
+  const std::string& expression,
+  std::vector<std::string>& tokens,
+  std::string& error) {
+  std::string current;
+  bool inQuotes = false;
+  bool hasToken = false;
+
+  for (char c : expression) {
+    if (c == '"') {
+      inQuotes = !inQuotes;
+      hasToken = true;
+    } else if (!inQuotes && std::isspace(static_cast<unsigned char>(c))) {
+      if (hasToken)
+        tokens.push_back(current);
+      current.clear();
+      hasToken = false;
+    } else {
+      current += c;
+      hasToken = true;
+    }
+  }
+
+  if (inQuotes) {
+    error = "Unterminated quote";
+    return false;
+  }
+  if (hasToken)
+    tokens.push_back(current);
+  return true;
+}
+
+static bool parsePriority(const std::string& value, Priority& priority) {
+  std::string lower = Utils::toLowerCase(value);
+  if (lower == "high" || lower == "h") {
+    priority = Priority::HIGH;
+  } else if (lower == "medium" || lower == "m") {
+    priority = Priority::MEDIUM;
+  } else if (lower == "low" || lower == "l") {
+    priority = Priority::LOW;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+static bool parseSortKey(const std::string& value, SortKey& key) {
+  std::string lower = Utils::toLowerCase(value);
+  if (lower == "id") {
+    key = SortKey::ID;
+  } else if (lower == "title") {
+    key = SortKey::TITLE;
+  } else if (lower == "due" || lower == "duedate") {
+    key = SortKey::DUE_DATE;
+  } else if (lower == "priority") {
+    key = SortKey::PRIORITY;
+  } else if (lower == "created") {
+    key = SortKey::CREATED;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+// Splits "field<op>value" where op is one of : = < <= > >=.
+static bool splitComparison(
+  const std::string& token,
+  std::string& field,
+  std::string& op,
+  std::string& value) {
+  size_t pos = token.find_first_of(":=<>");
+  if (pos == std::string::npos || pos == 0)
+    return false;
+
+  field = Utils::toLowerCase(token.substr(0, pos));
+  size_t opEnd = pos + 1;
+  if (
+    (token[pos] == '<' || token[pos] == '>') && opEnd < token.size() &&
+    token[opEnd] == '=') {
+    ++opEnd;
+  }
+  op = token.substr(pos, opEnd - pos);
+  if (op == ":")
+    op = "=";
+  value = token.substr(opEnd);
+  return true;
+}
+
+bool Query::parse(
+  const std::string& expression,
+  Query& query,
+  std::string& error) {
+  std::vector<std::string> tokens;
+  if (!tokenize(expression, tokens, error))
+    return false;
+
+  query = Query();
+  bool negate = false;
+
+  for (const std::string& token : tokens) {
+    std::string lower = Utils::toLowerCase(token);
+    if (lower == "and" || lower == "&&")
+      continue;
+    if (lower == "not" || lower == "!") {
+      negate = !negate;
+      continue;
+    }
+
+    bool negated = negate;
+    negate = false;
+    std::string word = lower;
+    if (word.size() > 1 && word[0] == '!') {
+      negated = !negated;
+      word = word.substr(1);
+    }
+
+    if (word == "done" || word == "completed") {
+      query.completed = !negated;
+      continue;
+    }
+    if (word == "pending" || word == "open") {
+      query.completed = negated;
+      continue;
+    }
+    if (negated) {
+      error = "Only done/pending can be negated: " + token;
+      return false;
+    }
+
+    std::string field, op, value;
+    if (!splitComparison(token, field, op, value)) {
+      // A bare word is a text search term.
+      query.text = query.text ? *query.text + " " + token : token;
+      continue;
+    }
+    if (value.empty()) {
+      error = "Missing value in: " + token;
+      return false;
+    }
+
+    if (field == "category" || field == "cat") {
+      if (op != "=") {
+        error = "Category only supports '=': " + token;
+        return false;
+      }
+      query.category = value;
+    } else if (field == "text") {
+      query.text = value;
+    } else if (field == "priority" || field == "p") {
+      Priority priority;
+      if (!parsePriority(value, priority)) {
+        error = "Unknown priority: " + value;
+        return false;
+      }
+      int level = static_cast<int>(priority);
+      if (op == "=" || op == ">=") {
+        query.minPriority = priority;
+      }
+      if (op == "=" || op == "<=") {
+        query.maxPriority = priority;
+      }
+      if (op == ">") {
+        if (level == static_cast<int>(Priority::HIGH)) {
+          error = "Nothing is above high priority";
+          return false;
+        }
+        query.minPriority = static_cast<Priority>(level + 1);
+      }
+      if (op == "<") {
+        if (level == static_cast<int>(Priority::LOW)) {
+          error = "Nothing is below low priority";
+          return false;
+        }
+        query.maxPriority = static_cast<Priority>(level - 1);
+      }
+    } else if (field == "due") {
+      if (!Utils::isValidDate(value)) {
+        error = "Dates must be YYYY-MM-DD: " + value;
+        return false;
+      }
+      if (op == "=" || op == ">=" || op == ">") {
+        query.dueFrom = value;
+        query.dueFromInclusive = op != ">";
+      }
+      if (op == "=" || op == "<=" || op == "<") {
+        query.dueTo = value;
+        query.dueToInclusive = op != "<";
+      }
+    } else if (field == "done" || field == "completed") {
+      std::string flag = Utils::toLowerCase(value);
+      if (flag != "true" && flag != "false" && flag != "yes" && flag != "no") {
+        error = "Expected true or false: " + token;
+        return false;
+      }
+      query.completed = flag == "true" || flag == "yes";
+    } else if (field == "sort") {
+      bool descending = value[0] == '-';
+      if (!parseSortKey(descending ? value.substr(1) : value, query.sortKey)) {
+        error = "Unknown sort key: " + value;
+        return false;
+      }
+      query.descending = descending;
+    } else if (field == "limit") {
+      if (!Utils::isValidInteger(value) || Utils::stringToInt(value) <= 0) {
+        error = "Limit must be a positive number: " + value;
+        return false;
+      }
+      query.limit = static_cast<size_t>(Utils::stringToInt(value));
+    } else {
+      error = "Unknown field: " + field;
+      return false;
+    }
+  }
+
+  if (negate) {
+    error = "Dangling 'not'";
+    return false;
+  }
+  return true;
+}
+
+std::string QueryPlan::describe() const {
+  std::string source;
+  switch (this->source) {
+    case QuerySource::CATEGORY_INDEX:
+      source = "category index";
+      break;
+    case QuerySource::DUE_DATE_INDEX:
+      source = "due date index";
+      break;
+    case QuerySource::FULL_SCAN:
+      source = "full scan";
+      break;
+  }
+  return source + " (" + std::to_string(estimatedCandidates) + " candidates)";
+}
@@ -0,0 +1,350 @@
+#include "../include/Recurrence.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <sstream>
+#include <vector>
+
+#include "../include/Utils.h"
+
+static const char* const WEEKDAY_NAMES[] =
+  {"sun", "mon", "tue", "wed", "thu", "fri", "sat"};
+static const char* const MONTH_NAMES[] = {
+  "jan",
+  "feb",
+  "mar",
+  "apr",
+  "may",
+  "jun",
+  "jul",
+  "aug",
+  "sep",
+  "oct",
+  "nov",
+  "dec"};
+
+// Long enough for any satisfiable day/month/weekday combination to come
+// round again (29 February on a given weekday recurs within 28 years).
+static const long CRON_SEARCH_DAYS = 28 * 366;
+static const int MAX_INTERVAL = 1000;
+
+// 1970-01-01 was a Thursday.
+static int weekdayOf(long days) {
+  return static_cast<int>(((days + 4) % 7 + 7) % 7);
+}
+
+static std::string formatDate(int year, int month, int day) {
+  if (year < 0 || year > 9999)
+    return "";
+  char buffer[16];
+  snprintf(buffer, sizeof(buffer), "%04d-%02d-%02d", year, month, day);
+  return buffer;
+}
+
+// Accepts a number in [low, high] or one of `names`, which stand for
+// low, low + 1, ...
+static bool parseValue(
+  const std::string& text,
+  int low,
+  int high,
+  const char* const* names,
+  int nameCount,
+  int& value) {
+  for (int i = 0; i < nameCount; ++i) {
+    if (text == names[i]) {
+      value = low + i;
+      return true;
+    }
+  }
+  if (!Utils::isValidInteger(text) || text[0] == '-' || text[0] == '+')
+    return false;
+  value = Utils::stringToInt(text);
+  return value >= low && value <= high;
+}
+
+// One crontab field: comma-separated items, each "*", "a" or "a-b" with an
+// optional "/step". Sets bit v of `mask` for every value v it covers.
+static bool parseCronField(
+  const std::string& field,
+  int low,
+  int high,
+  const char* const* names,
+  int nameCount,
+  uint32_t& mask,
+  std::string& error) {
+  mask = 0;
+  std::stringstream items(field);
+  std::string item;
+  while (std::getline(items, item, ',')) {
+    int step = 1;
+    size_t slash = item.find('/');
+    if (slash != std::string::npos) {
+      std::string stepText = item.substr(slash + 1);
+      if (
+        !parseValue(stepText, 1, high, nullptr, 0, step) || step < 1 ||
+        slash == 0) {
+        error = "Invalid step in: " + field;
+        return false;
+      }
+      item = item.substr(0, slash);
+    }
+
+    int first = low;
+    int last = high;
+    if (item != "*") {
+      size_t dash = item.find('-');
+      std::string from = item.substr(0, dash);
+      std::string to = dash == std::string::npos ? "" : item.substr(dash + 1);
+      bool valid = parseValue(from, low, high, names, nameCount, first);
+      if (dash != std::string::npos) {
+        valid = valid && parseValue(to, low, high, names, nameCount, last);
+      } else {
+        last = slash == std::string::npos ? first : high;
+      }
+      if (!valid) {
+        error = "Invalid value in: " + field;
+        return false;
+      }
+      if (first > last) {
+        error = "Range is reversed in: " + field;
+        return false;
+      }
+    }
+
+    for (int value = first; value <= last; value += step) {
+      mask |= uint32_t(1) << value;
+    }
+  }
+
+  if (mask == 0) {
+    error = "Empty field in cron rule";
+    return false;
+  }
+  return true;
+}
+
+Recurrence::Recurrence()
+    : kind(RecurrenceKind::NONE),
+      interval(1),
+      dayOfMonth(0),
+      weekdays(0),
+      monthDays(0),
+      months(0),
+      anyMonthDay(true),
+      anyWeekday(true) {}
+
+bool Recurrence::parse(
+  const std::string& text,
+  Recurrence& rule,
+  std::string& error) {
+  std::string spec = Utils::toLowerCase(Utils::trim(text));
+  rule = Recurrence();
+  if (spec.empty() || spec == "none")
+    return true;
+
+  if (spec.compare(0, 5, "cron:") == 0) {
+    std::stringstream stream(spec.substr(5));
+    std::vector<std::string> fields;
+    std::string field;
+    while (stream >> field) {
+      fields.push_back(field);
+    }
+    if (fields.size() != 3) {
+      error = "A cron rule needs <days> <months> <weekdays>: " + text;
+      return false;
+    }
+
+    uint32_t dayMask, monthMask, weekdayMask;
+    if (
+      !parseCronField(fields[0], 1, 31, nullptr, 0, dayMask, error) ||
+      !parseCronField(fields[1], 1, 12, MONTH_NAMES, 12, monthMask, error) ||
+      !parseCronField(fields[2], 0, 7, WEEKDAY_NAMES, 7, weekdayMask, error))
+      return false;
+
+    rule.kind = RecurrenceKind::CRON;
+    rule.monthDays = dayMask;
+    rule.months = static_cast<uint16_t>(monthMask);
+    // Both 0 and 7 mean Sunday.
+    rule.weekdays =
+      static_cast<uint8_t>((weekdayMask | weekdayMask >> 7) & 0x7F);
+    rule.anyMonthDay = fields[0] == "*";
+    rule.anyWeekday = fields[2] == "*";
+    rule.cronFields = fields[0] + " " + fields[1] + " " + fields[2];
+
+    if (rule.nextAfter("2000-01-01").empty()) {
+      error = "Rule never matches a date: " + text;
+      return false;
+    }
+    return true;
+  }
+
+  size_t colon = spec.find(':');
+  std::string head = spec.substr(0, colon);
+  std::string arguments =
+    colon == std::string::npos ? "" : spec.substr(colon + 1);
+  size_t slash = head.find('/');
+  std::string name = head.substr(0, slash);
+
+  if (slash != std::string::npos) {
+    std::string count = head.substr(slash + 1);
+    if (!parseValue(count, 1, MAX_INTERVAL, nullptr, 0, rule.interval)) {
+      error = "Invalid interval: " + text;
+      return false;
+    }
+  }
+
+  if (name == "daily") {
+    rule.kind = RecurrenceKind::DAILY;
+    if (!arguments.empty()) {
+      error = "Daily rules take no arguments: " + text;
+      return false;
+    }
+  } else if (name == "weekly") {
+    rule.kind = RecurrenceKind::WEEKLY;
+    std::stringstream days(arguments);
+    std::string day;
+    while (std::getline(days, day, ',')) {
+      int weekday;
+      if (!parseValue(Utils::trim(day), 0, 6, WEEKDAY_NAMES, 7, weekday)) {
+        error = "Unknown weekday: " + day;
+        return false;
+      }
+      rule.weekdays |= static_cast<uint8_t>(1 << weekday);
+    }
+  } else if (name == "monthly") {
+    rule.kind = RecurrenceKind::MONTHLY;
+    if (
+      !arguments.empty() &&
+      !parseValue(arguments, 1, 31, nullptr, 0, rule.dayOfMonth)) {
+      error = "Invalid day of the month: " + arguments;
+      return false;
+    }
+  } else {
+    error = "Unknown repeat rule: " + text;
+    return false;
+  }
+  return true;
+}
+
+std::string Recurrence::toString() const {
+  std::string every = interval > 1 ? "/" + std::to_string(interval) : "";
+  switch (kind) {
+    case RecurrenceKind::DAILY:
+      return "daily" + every;
+    case RecurrenceKind::WEEKLY: {
+      std::string result = "weekly" + every;
+      // Monday first, as people write them.
+      for (int i = 1; i <= 7; ++i) {
+        if (weekdays & (1 << (i % 7))) {
+          result += result.find(':') == std::string::npos ? ":" : ",";
+          result += WEEKDAY_NAMES[i % 7];
+        }
+      }
+      return result;
+    }
+    case RecurrenceKind::MONTHLY:
+      return "monthly" + every +
+             (dayOfMonth ? ":" + std::to_string(dayOfMonth) : "");
+    case RecurrenceKind::CRON:
+      return "cron:" + cronFields;
+    default:
+      return "";
+  }
+}
+
+std::string Recurrence::nextAfter(const std::string& date) const {
+  long base;
+  if (kind == RecurrenceKind::NONE || !Utils::dateToDays(date, base))
+    return "";
+
+  int year = std::stoi(date.substr(0, 4));
+  int month = std::stoi(date.substr(5, 2));
+  int day = std::stoi(date.substr(8, 2));
+
+  switch (kind) {
+    case RecurrenceKind::DAILY:
+      return Utils::daysToDate(base + interval);
+
+    case RecurrenceKind::WEEKLY: {
+      if (!weekdays)
+        return Utils::daysToDate(base + 7L * interval);
+      // Weeks start on Monday and are counted from the one holding `date`.
+      long baseWeek = base - (weekdayOf(base) + 6) % 7;
+      for (long next = base + 1; next <= base + 7L * (interval + 1); ++next) {
+        int weekday = weekdayOf(next);
+        long week = (next - (weekday + 6) % 7 - baseWeek) / 7;
+        if (week % interval == 0 && (weekdays & (1 << weekday)))
+          return Utils::daysToDate(next);
+      }
+      return "";
+    }
+
+    case RecurrenceKind::MONTHLY: {
+      int target = dayOfMonth ? dayOfMonth : day;
+      int clamped = std::min(target, Utils::daysInMonth(year, month));
+      if (clamped > day)
+        return formatDate(year, month, clamped);
+
+      int monthIndex = (month - 1) + interval;
+      year += monthIndex / 12;
+      month = monthIndex % 12 + 1;
+      return formatDate(
+        year, month, std::min(target, Utils::daysInMonth(year, month)));
+    }
+
+    case RecurrenceKind::CRON: {
+      // Walk the calendar a day at a time; the masks make each check a few
+      // bit tests.
+      int weekday = weekdayOf(base);
+      for (long step = 0; step < CRON_SEARCH_DAYS; ++step) {
+        weekday = (weekday + 1) % 7;
+        if (++day > Utils::daysInMonth(year, month)) {
+          day = 1;
+          if (++month > 12) {
+            month = 1;
+            ++year;
+          }
+        }
+
+        if (!(months & (1 << month)))
+          continue;
+        bool dayMatches = monthDays & (uint32_t(1) << day);
+        bool weekdayMatches = weekdays & (1 << weekday);
+        // As in cron, restricting both fields matches either of them.
+        bool matches = anyMonthDay || anyWeekday
+                         ? dayMatches && weekdayMatches
+                         : dayMatches || weekdayMatches;
+        if (matches)
+          return formatDate(year, month, day);
+      }
+      return "";
+    }
+
+    default:
+      return "";
+  }
+}
+
+std::string Recurrence::nextOccurrence(
+  const std::string& dueDate,
+  const std::string& today) const {
+  long unused;
+  std::string next =
+    nextAfter(Utils::dateToDays(dueDate, unused) ? dueDate : today);
+  for (int skipped = 0; !next.empty() && next < today && skipped < 100000;
+       ++skipped) {
+    next = nextAfter(next);
+  }
+  return next;
+}
+
+Recurrence Recurrence::anchoredTo(const std::string& dueDate) const {
+  Recurrence anchored = *this;
+  long unused;
+  if (
+    kind == RecurrenceKind::MONTHLY && dayOfMonth == 0 &&
+    Utils::dateToDays(dueDate, unused)) {
+    anchored.dayOfMonth = std::stoi(dueDate.substr(8, 2));
+  }
+  return anchored;
+}
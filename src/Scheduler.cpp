@@ -0,0 +1,55 @@
+#include "../include/Scheduler.h"
+
+#include <algorithm>
+
+#include "../include/Profiler.h"
+
+// std::push_heap builds a max-heap, so "later" ranks lower.
+static bool later(const ScheduledTask& a, const ScheduledTask& b) {
+  return a.dueDate != b.dueDate ? a.dueDate > b.dueDate : a.taskId > b.taskId;
+}
+
+void Scheduler::schedule(const Task& task) {
+  if (task.isCompleted() || task.getDueDate().empty())
+    return;
+
+  heap.push_back({task.getDueDate(), task.getId()});
+  std::push_heap(heap.begin(), heap.end(), later);
+}
+
+void Scheduler::forget(int taskId) {
+  announced.erase(taskId);
+}
+
+void Scheduler::clear() {
+  heap.clear();
+}
+
+void Scheduler::reset() {
+  heap.clear();
+  announced.clear();
+}
+
+std::vector<int> Scheduler::takeDue(
+  const std::string& horizon,
+  const std::function<bool(const ScheduledTask&)>& isCurrent) {
+  PROFILE_SCOPE("Scheduler::takeDue");
+  std::vector<int> due;
+  while (!heap.empty() && heap.front().dueDate <= horizon) {
+    std::pop_heap(heap.begin(), heap.end(), later);
+    ScheduledTask entry = std::move(heap.back());
+    heap.pop_back();
+
+    if (!isCurrent(entry)) {
+      PROFILE_COUNT("scheduler.stale", 1);
+      continue;
+    }
+    auto previous = announced.find(entry.taskId);
+    if (previous != announced.end() && previous->second == entry.dueDate)
+      continue;
+
+    announced[entry.taskId] = entry.dueDate;
+    due.push_back(entry.taskId);
+  }
+  return due;
+}
@@ -0,0 +1,47 @@
+#include "../include/Screen.h"
+
+#include "../include/Profiler.h"
+
+Screen::Screen(std::ostream& out)
+    : out(out), columns(0), rows(0), valid(false) {}
+
+void Screen::setSize(int width, int height) {
+  if (width != columns || height != rows) {
+    columns = width;
+    rows = height;
+    valid = false;
+  }
+}
+
+void Screen::invalidate() {
+  valid = false;
+}
+
+size_t Screen::present(const std::vector<std::string>& frame) {
+  PROFILE_SCOPE("Screen::present");
+  std::string output;
+  if (!valid) {
+    output = "\033[H\033[2J";
+    shown.clear();
+  }
+
+  size_t changed = 0;
+  for (size_t row = 0; row < frame.size(); ++row) {
+    if (row < shown.size() && shown[row] == frame[row])
+      continue;
+    output += "\033[" + std::to_string(row + 1) + ";1H";
+    output += frame[row];
+    output += "\033[K";
+    ++changed;
+  }
+
+  // Clears what is left of a longer previous frame along with the prompt
+  // and echoed input below it.
+  output += "\033[" + std::to_string(frame.size() + 1) + ";1H\033[J";
+  out << output << std::flush;
+
+  shown = frame;
+  valid = true;
+  PROFILE_COUNT("screen.rows_written", changed);
+  return changed;
+}
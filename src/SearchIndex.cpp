@@ -0,0 +1,440 @@
+#include "../include/SearchIndex.h"
+
+#include <algorithm>
+#include <unordered_set>
+#include <utility>
+
+#include "../include/Profiler.h"
+
+namespace {
+
+// Myers' bit-parallel Levenshtein distance (Hyyrö's formulation) for
+// patterns up to 64 bytes: one pass over the text, a handful of word
+// operations per byte.
+class MyersPattern {
+ private:
+  uint64_t peq[256];
+  size_t length;
+
+ public:
+  explicit MyersPattern(const std::string& pattern) : length(pattern.size()) {
+    std::fill(peq, peq + 256, 0);
+    for (size_t i = 0; i < length; ++i) {
+      peq[static_cast<unsigned char>(pattern[i])] |= uint64_t(1) << i;
+    }
+  }
+
+  size_t distance(const std::string& text) const {
+    if (length == 0) {
+      return text.size();
+    }
+
+    uint64_t last = uint64_t(1) << (length - 1);
+    uint64_t pv = ~uint64_t(0);
+    uint64_t mv = 0;
+    size_t score = length;
+    for (unsigned char c : text) {
+      uint64_t eq = peq[c];
+      uint64_t xv = eq | mv;
+      uint64_t xh = (((eq & pv) + pv) ^ pv) | eq;
+      uint64_t ph = mv | ~(xh | pv);
+      uint64_t mh = pv & xh;
+      if (ph & last) {
+        score++;
+      } else if (mh & last) {
+        score--;
+      }
+      ph = (ph << 1) | 1;
+      mh <<= 1;
+      pv = mh | ~(xv | ph);
+      mv = ph & xv;
+    }
+    return score;
+  }
+};
+
+constexpr size_t MAX_MYERS_LENGTH = 64;
+constexpr size_t MIN_COMPACTION = 4096;
+
+// Trigrams of "$word$", so short words and word edges still produce some.
+std::vector<uint32_t> trigramsOf(const std::string& word) {
+  std::string padded = "$" + word + "$";
+  std::vector<uint32_t> result;
+  result.reserve(word.size());
+  for (size_t i = 0; i + 3 <= padded.size(); ++i) {
+    result.push_back(
+      static_cast<uint32_t>(static_cast<unsigned char>(padded[i])) << 16 |
+      static_cast<uint32_t>(static_cast<unsigned char>(padded[i + 1])) << 8 |
+      static_cast<uint32_t>(static_cast<unsigned char>(padded[i + 2])));
+  }
+  std::sort(result.begin(), result.end());
+  result.erase(std::unique(result.begin(), result.end()), result.end());
+  return result;
+}
+
+size_t maxEditsFor(size_t length) {
+  if (length <= 3)
+    return 0;
+  return length <= 6 ? 1 : 2;
+}
+
+bool isWordByte(unsigned char c) {
+  return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+         (c >= '0' && c <= '9') || c >= 0x80;
+}
+
+}  // namespace
+
+SearchIndex::SearchIndex()
+    : nextStamp(0), livePostings(0), deadPostings(0), built(false) {}
+
+std::vector<std::string> SearchIndex::tokenize(const std::string& text) {
+  std::vector<std::string> tokens;
+  std::string current;
+  for (char ch : text) {
+    unsigned char c = static_cast<unsigned char>(ch);
+    if (isWordByte(c)) {
+      current += (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : ch;
+    } else if (!current.empty()) {
+      tokens.push_back(current);
+      current.clear();
+    }
+  }
+  if (!current.empty()) {
+    tokens.push_back(current);
+  }
+  return tokens;
+}
+
+size_t SearchIndex::editDistance(const std::string& a, const std::string& b) {
+  const std::string& shorter = a.size() <= b.size() ? a : b;
+  const std::string& longer = a.size() <= b.size() ? b : a;
+  if (shorter.size() <= MAX_MYERS_LENGTH) {
+    return MyersPattern(shorter).distance(longer);
+  }
+
+  std::vector<size_t> row(shorter.size() + 1);
+  for (size_t i = 0; i <= shorter.size(); ++i) {
+    row[i] = i;
+  }
+  for (size_t j = 1; j <= longer.size(); ++j) {
+    size_t diagonal = row[0];
+    row[0] = j;
+    for (size_t i = 1; i <= shorter.size(); ++i) {
+      size_t above = row[i];
+      size_t substitution = diagonal + (shorter[i - 1] != longer[j - 1]);
+      row[i] = std::min({above + 1, row[i - 1] + 1, substitution});
+      diagonal = above;
+    }
+  }
+  return row[shorter.size()];
+}
+
+uint32_t SearchIndex::internTerm(const std::string& term) {
+  auto it = termIds.find(term);
+  if (it != termIds.end()) {
+    return it->second;
+  }
+
+  uint32_t id = static_cast<uint32_t>(terms.size());
+  it = termIds.emplace(term, id).first;
+  terms.push_back(&it->first);
+  postings.emplace_back();
+  for (uint32_t trigram : trigramsOf(term)) {
+    trigramTerms[trigram].push_back(id);
+  }
+  return id;
+}
+
+void SearchIndex::addField(
+  const std::string& text,
+  uint32_t slot,
+  uint32_t stamp,
+  bool inTitle,
+  uint32_t& added) {
+  // Called once per field of every task on a build, so words are gathered
+  // into reused buffers rather than through tokenize().
+  fieldTerms.clear();
+  word.clear();
+  for (size_t i = 0; i <= text.size(); ++i) {
+    unsigned char c = i < text.size() ? static_cast<unsigned char>(text[i]) : 0;
+    if (isWordByte(c)) {
+      word += (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a')
+                                     : static_cast<char>(c);
+    } else if (!word.empty()) {
+      fieldTerms.push_back(internTerm(word));
+      word.clear();
+    }
+  }
+
+  std::sort(fieldTerms.begin(), fieldTerms.end());
+  fieldTerms.erase(
+    std::unique(fieldTerms.begin(), fieldTerms.end()), fieldTerms.end());
+  for (uint32_t term : fieldTerms) {
+    postings[term].push_back({slot, stamp, inTitle});
+  }
+  added += static_cast<uint32_t>(fieldTerms.size());
+}
+
+void SearchIndex::sortNewTerms() {
+  size_t sorted = sortedTerms.size();
+  if (sorted == terms.size())
+    return;
+
+  for (size_t term = sorted; term < terms.size(); ++term) {
+    sortedTerms.push_back(static_cast<uint32_t>(term));
+  }
+  auto byText = [this](uint32_t a, uint32_t b) {
+    return *terms[a] < *terms[b];
+  };
+  std::sort(sortedTerms.begin() + sorted, sortedTerms.end(), byText);
+  std::inplace_merge(
+    sortedTerms.begin(),
+    sortedTerms.begin() + sorted,
+    sortedTerms.end(),
+    byText);
+}
+
+void SearchIndex::add(const Task& task) {
+  int id = task.getId();
+  remove(id);
+
+  uint32_t slot;
+  if (!freeSlots.empty()) {
+    slot = freeSlots.back();
+    freeSlots.pop_back();
+  } else {
+    slot = static_cast<uint32_t>(stamps.size());
+    stamps.push_back(0);
+    postingCounts.push_back(0);
+    slotTasks.push_back(0);
+  }
+  slotOf[id] = slot;
+  slotTasks[slot] = id;
+
+  uint32_t stamp = ++nextStamp;
+  uint32_t added = 0;
+  addField(task.getTitle(), slot, stamp, true, added);
+  addField(task.getDescription(), slot, stamp, false, added);
+  stamps[slot] = stamp;
+  postingCounts[slot] = added;
+  livePostings += added;
+}
+
+void SearchIndex::remove(int taskId) {
+  auto found = slotOf.find(taskId);
+  if (found == slotOf.end())
+    return;
+
+  uint32_t slot = found->second;
+  slotOf.erase(found);
+  freeSlots.push_back(slot);
+  stamps[slot] = 0;
+  livePostings -= postingCounts[slot];
+  deadPostings += postingCounts[slot];
+  postingCounts[slot] = 0;
+
+  if (deadPostings > livePostings && deadPostings >= MIN_COMPACTION) {
+    compact();
+  }
+}
+
+void SearchIndex::clear() {
+  termIds.clear();
+  terms.clear();
+  sortedTerms.clear();
+  postings.clear();
+  trigramTerms.clear();
+  slotOf.clear();
+  slotTasks.clear();
+  freeSlots.clear();
+  stamps.clear();
+  postingCounts.clear();
+  tokensHit.clear();
+  bestScore.clear();
+  totalScore.clear();
+  trigramCounts.clear();
+  livePostings = 0;
+  deadPostings = 0;
+}
+
+void SearchIndex::compact() {
+  PROFILE_SCOPE("SearchIndex::compact");
+  for (std::vector<Posting>& list : postings) {
+    list.erase(
+      std::remove_if(
+        list.begin(),
+        list.end(),
+        [this](const Posting& posting) {
+          return stamps[posting.slot] != posting.stamp;
+        }),
+      list.end());
+  }
+  deadPostings = 0;
+}
+
+// Every vocabulary term the token may stand for, with how well it matches.
+// Prefixes come from the ordered vocabulary. For longer tokens, terms
+// sharing enough trigrams are checked for containing the token or being
+// within maxEditsFor() edits of it: an edit destroys at most three
+// trigrams, so a term within k edits shares at least length - 3k of them.
+std::vector<SearchIndex::TermMatch> SearchIndex::expandToken(
+  const std::string& token) {
+  std::vector<TermMatch> matches;
+  std::unordered_set<uint32_t> matched;
+
+  auto first = std::lower_bound(
+    sortedTerms.begin(),
+    sortedTerms.end(),
+    token,
+    [this](uint32_t term, const std::string& text) {
+      return *terms[term] < text;
+    });
+  for (auto it = first; it != sortedTerms.end(); ++it) {
+    const std::string& candidate = *terms[*it];
+    if (candidate.compare(0, token.size(), token) != 0)
+      break;
+    matched.insert(*it);
+    matches.push_back(
+      {*it, candidate.size() == token.size() ? EXACT_SCORE : PREFIX_SCORE});
+  }
+
+  if (token.size() < 3) {
+    return matches;
+  }
+
+  std::vector<uint32_t> grams = trigramsOf(token);
+  trigramCounts.resize(terms.size(), 0);
+  std::vector<uint32_t> candidates;
+  for (uint32_t gram : grams) {
+    auto list = trigramTerms.find(gram);
+    if (list == trigramTerms.end())
+      continue;
+    for (uint32_t term : list->second) {
+      if (trigramCounts[term]++ == 0) {
+        candidates.push_back(term);
+      }
+    }
+  }
+
+  size_t maxEdits = maxEditsFor(token.size());
+  size_t fuzzyThreshold = token.size() - 3 * maxEdits;
+  size_t substringThreshold = token.size() - 2;
+  MyersPattern pattern(token.size() <= MAX_MYERS_LENGTH ? token : "");
+
+  for (uint32_t term : candidates) {
+    size_t shared = trigramCounts[term];
+    trigramCounts[term] = 0;
+    if (matched.count(term))
+      continue;
+
+    const std::string& word = *terms[term];
+    double score = 0;
+    if (shared >= substringThreshold && word.find(token) != std::string::npos) {
+      score = SUBSTRING_SCORE;
+    }
+    size_t lengthGap = word.size() > token.size() ? word.size() - token.size()
+                                                  : token.size() - word.size();
+    if (maxEdits > 0 && shared >= fuzzyThreshold && lengthGap <= maxEdits) {
+      size_t distance = token.size() <= MAX_MYERS_LENGTH
+                          ? pattern.distance(word)
+                          : editDistance(token, word);
+      if (distance == 1) {
+        score = std::max(score, ONE_EDIT_SCORE);
+      } else if (distance <= maxEdits) {
+        score = std::max(score, TWO_EDIT_SCORE);
+      }
+    }
+    if (score > 0) {
+      matches.push_back({term, score});
+    }
+  }
+  return matches;
+}
+
+std::vector<SearchHit> SearchIndex::search(
+  const std::string& text,
+  size_t limit) {
+  PROFILE_SCOPE("SearchIndex::search");
+  std::vector<std::string> tokens = tokenize(text);
+  std::sort(tokens.begin(), tokens.end());
+  tokens.erase(std::unique(tokens.begin(), tokens.end()), tokens.end());
+  if (tokens.empty() || limit == 0) {
+    return {};
+  }
+
+  sortNewTerms();
+  std::vector<std::vector<TermMatch>> expansions;
+  std::vector<std::pair<size_t, size_t>> order;
+  for (const std::string& token : tokens) {
+    expansions.push_back(expandToken(token));
+    size_t work = 0;
+    for (const TermMatch& match : expansions.back()) {
+      work += postings[match.term].size();
+    }
+    if (work == 0) {
+      return {};
+    }
+    order.emplace_back(work, expansions.size() - 1);
+  }
+  // The rarest word picks the candidates; later words only filter them.
+  std::sort(order.begin(), order.end());
+
+  tokensHit.resize(stamps.size(), 0);
+  bestScore.resize(stamps.size(), 0);
+  totalScore.resize(stamps.size(), 0);
+  std::vector<uint32_t> candidates;
+
+  for (uint32_t round = 0; round < order.size(); ++round) {
+    for (const TermMatch& match : expansions[order[round].second]) {
+      for (const Posting& posting : postings[match.term]) {
+        uint32_t id = posting.slot;
+        if (stamps[id] != posting.stamp || tokensHit[id] < round)
+          continue;
+
+        float score = static_cast<float>(
+          match.score * (posting.inTitle ? TITLE_WEIGHT : DESCRIPTION_WEIGHT));
+        if (tokensHit[id] == round) {
+          tokensHit[id] = round + 1;
+          bestScore[id] = score;
+          if (round == 0) {
+            candidates.push_back(id);
+          }
+        } else if (score > bestScore[id]) {
+          bestScore[id] = score;
+        }
+      }
+    }
+
+    size_t kept = 0;
+    for (uint32_t id : candidates) {
+      if (tokensHit[id] == round + 1) {
+        totalScore[id] += bestScore[id];
+        candidates[kept++] = id;
+      } else {
+        tokensHit[id] = 0;
+        totalScore[id] = 0;
+      }
+    }
+    candidates.resize(kept);
+  }
+
+  std::vector<SearchHit> hits;
+  hits.reserve(candidates.size());
+  for (uint32_t id : candidates) {
+    hits.push_back({slotTasks[id], totalScore[id]});
+    tokensHit[id] = 0;
+    totalScore[id] = 0;
+  }
+
+  auto better = [](const SearchHit& a, const SearchHit& b) {
+    return a.score != b.score ? a.score > b.score : a.taskId < b.taskId;
+  };
+  if (hits.size() > limit) {
+    std::partial_sort(hits.begin(), hits.begin() + limit, hits.end(), better);
+    hits.resize(limit);
+  } else {
+    std::sort(hits.begin(), hits.end(), better);
+  }
+  return hits;
+}
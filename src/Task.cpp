@@ -2,8 +2,11 @@
 
 #include <iomanip>
 #include <sstream>
+#include <stdexcept>
 #include <vector>
 
+#include "../include/Utils.h"
+
 Task::Task(
   int id,
   const std::string& title,
@@ -21,6 +24,10 @@ Task::Task(
       createdAt(time(nullptr)),
       completedAt(0) {}
 
+Task::Task(const Task& other, int id) : Task(other) {
+  this->id = id;
+}
+
 void Task::markAsCompleted() {
   completed = true;
   completedAt = time(nullptr);
@@ -31,6 +38,12 @@ void Task::markAsIncomplete() {
   completedAt = 0;
 }
 
+void Task::restoreState(bool completed, time_t createdAt, time_t completedAt) {
+  this->completed = completed;
+  this->createdAt = createdAt;
+  this->completedAt = completed ? completedAt : 0;
+}
+
 std::string Task::priorityToString() const {
   switch (priority) {
     case Priority::LOW:
@@ -44,11 +57,76 @@ std::string Task::priorityToString() const {
   }
 }
 
+// Text fields are escaped so that '|' only ever separates fields and a record
+// always fits on one line: '\\' -> backslash, '\p' -> '|', '\n' and '\r'.
+static std::string escapeField(const std::string& value) {
+  if (value.find_first_of("\\|\n\r") == std::string::npos)
+    return value;
+
+  std::string result;
+  result.reserve(value.size() + 8);
+  for (char c : value) {
+    switch (c) {
+      case '\\':
+        result += "\\\\";
+        break;
+      case '|':
+        result += "\\p";
+        break;
+      case '\n':
+        result += "\\n";
+        break;
+      case '\r':
+        result += "\\r";
+        break;
+      default:
+        result += c;
+    }
+  }
+  return result;
+}
+
+// Unknown escapes are kept verbatim so files written before escaping was
+// introduced still load unchanged.
+static std::string unescapeField(const std::string& value) {
+  if (value.find('\\') == std::string::npos)
+    return value;
+
+  std::string result;
+  result.reserve(value.size());
+  for (size_t i = 0; i < value.size(); ++i) {
+    if (value[i] != '\\' || i + 1 == value.size()) {
+      result += value[i];
+      continue;
+    }
+    char next = value[++i];
+    switch (next) {
+      case '\\':
+        result += '\\';
+        break;
+      case 'p':
+        result += '|';
+        break;
+      case 'n':
+        result += '\n';
+        break;
+      case 'r':
+        result += '\r';
+        break;
+      default:
+        result += '\\';
+        result += next;
+    }
+  }
+  return result;
+}
+
 std::string Task::serialize() const {
   std::stringstream ss;
-  ss << id << "|" << title << "|" << description << "|" << category << "|"
-     << dueDate << "|" << static_cast<int>(priority) << "|" << completed << "|"
-     << createdAt << "|" << completedAt;
+  ss << id << "|" << escapeField(title) << "|" << escapeField(description)
+     << "|" << escapeField(category) << "|" << escapeField(dueDate) << "|"
+     << static_cast<int>(priority) << "|" << completed << "|" << createdAt
+     << "|" << completedAt << "|" << escapeField(recurrence.toString());
   return ss.str();
 }
 
@@ -65,13 +143,46 @@ Task Task::deserialize(const std::string& data) {
     throw std::runtime_error("Invalid task data");
   }
 
-  int id = std::stoi(tokens[0]);
-  Priority priority = static_cast<Priority>(std::stoi(tokens[5]));
+  // Every numeric field is parsed strictly and range-checked: a stray
+  // character or an out-of-range priority rejects the record instead of
+  // producing a task that no enum value describes.
+  long long id, priority, createdAt, completedAt;
+  if (!Utils::parseInt64(tokens[0], id) || id < 1 || id > MAX_ID) {
+    throw std::runtime_error("Invalid task id");
+  }
+  if (
+    !Utils::parseInt64(tokens[5], priority) ||
+    priority < static_cast<int>(Priority::LOW) ||
+    priority > static_cast<int>(Priority::HIGH)) {
+    throw std::runtime_error("Invalid priority");
+  }
+  if (tokens[6] != "0" && tokens[6] != "1") {
+    throw std::runtime_error("Invalid completion flag");
+  }
+  if (
+    !Utils::parseInt64(tokens[7], createdAt) ||
+    !Utils::parseInt64(tokens[8], completedAt)) {
+    throw std::runtime_error("Invalid timestamp");
+  }
 
-  Task task(id, tokens[1], tokens[2], tokens[3], tokens[4], priority);
-  task.completed = (tokens[6] == "1");
-  task.createdAt = std::stoll(tokens[7]);
-  task.completedAt = std::stoll(tokens[8]);
+  Task task(
+    static_cast<int>(id),
+    unescapeField(tokens[1]),
+    unescapeField(tokens[2]),
+    unescapeField(tokens[3]),
+    unescapeField(tokens[4]),
+    static_cast<Priority>(priority));
+  task.completed = tokens[6] == "1";
+  task.createdAt = static_cast<time_t>(createdAt);
+  task.completedAt = static_cast<time_t>(completedAt);
+
+  // Records written before recurrence existed have no tenth field.
+  if (tokens.size() > 9) {
+    std::string error;
+    if (!Recurrence::parse(unescapeField(tokens[9]), task.recurrence, error)) {
+      throw std::runtime_error(error);
+    }
+  }
 
   return task;
 }
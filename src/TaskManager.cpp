@@ -2,41 +2,276 @@
 
 #include <algorithm>
 
+#include "../include/Profiler.h"
 #include "../include/Utils.h"
 
 TaskManager::TaskManager() : nextId(1) {}
 
-void TaskManager::addTask(
+static bool byId(const Task* a, const Task* b) {
+  return a->getId() < b->getId();
+}
+
+void TaskManager::indexTask(Task* task, bool withCategory) {
+  idIndex[task->getId()] = task;
+  if (withCategory) {
+    std::vector<Task*>& members =
+      categoryIndex[Utils::toLowerCase(task->getCategory())];
+    members.insert(
+      std::upper_bound(members.begin(), members.end(), task, byId), task);
+  }
+  if (!task->getDueDate().empty()) {
+    dueDateIndex.emplace(task->getDueDate(), task);
+  }
+  if (searchIndex.isBuilt()) {
+    searchIndex.add(*task);
+  }
+  if (scheduler.isBuilt()) {
+    scheduler.schedule(*task);
+  }
+}
+
+void TaskManager::unindexTask(Task* task, bool withCategory) {
+  idIndex.erase(task->getId());
+  searchIndex.remove(task->getId());
+
+  auto bucket = withCategory
+                  ? categoryIndex.find(Utils::toLowerCase(task->getCategory()))
+                  : categoryIndex.end();
+  if (bucket != categoryIndex.end()) {
+    std::vector<Task*>& members = bucket->second;
+    members.erase(std::find(members.begin(), members.end(), task));
+    if (members.empty()) {
+      categoryIndex.erase(bucket);
+    }
+  }
+
+  if (!task->getDueDate().empty()) {
+    auto range = dueDateIndex.equal_range(task->getDueDate());
+    for (auto it = range.first; it != range.second; ++it) {
+      if (it->second == task) {
+        dueDateIndex.erase(it);
+        break;
+      }
+    }
+  }
+}
+
+void TaskManager::markModified(int id) {
+  modifiedIds.insert(id);
+}
+
+void TaskManager::markDeleted(int id) {
+  modifiedIds.erase(id);
+  deletedIds.insert(id);
+}
+
+// Marks a task done. A recurring task hands its rule on to a new task due
+// at the next occurrence, so reopening the old one cannot spawn it twice.
+// If no id is left for that task, the completed one keeps its rule.
+void TaskManager::completeTask(Task* task, int* nextOccurrenceId) {
+  statistics.remove(*task);
+  task->markAsCompleted();
+  statistics.add(*task);
+  markModified(task->getId());
+
+  if (!task->getRecurrence().isRecurring())
+    return;
+  Recurrence rule = task->getRecurrence().anchoredTo(task->getDueDate());
+  std::string next = rule.nextOccurrence(task->getDueDate(), Utils::today());
+  if (next.empty()) {
+    task->setRecurrence(Recurrence());
+    return;
+  }
+
+  bool added = addTask(
+    task->getTitle(),
+    task->getDescription(),
+    task->getCategory(),
+    next,
+    task->getPriority(),
+    rule);
+  if (!added)
+    return;
+  task->setRecurrence(Recurrence());
+  if (nextOccurrenceId) {
+    *nextOccurrenceId = tasks.back()->getId();
+  }
+}
+
+void TaskManager::reopenTask(Task* task) {
+  statistics.remove(*task);
+  task->markAsIncomplete();
+  statistics.add(*task);
+  markModified(task->getId());
+
+  if (scheduler.isBuilt()) {
+    scheduler.forget(task->getId());
+    scheduler.schedule(*task);
+  }
+}
+
+void TaskManager::clearChangeLog() {
+  modifiedIds.clear();
+  deletedIds.clear();
+}
+
+void TaskManager::insertTask(const Task& task) {
+  tasks.push_back(std::make_unique<Task>(task));
+  indexTask(tasks.back().get());
+  statistics.add(task);
+  if (task.getId() >= nextId) {
+    nextId = task.getId() + 1;
+  }
+}
+
+void TaskManager::eraseTask(Task* task) {
+  auto it = std::find_if(
+    tasks.begin(), tasks.end(), [task](const std::unique_ptr<Task>& entry) {
+      return entry.get() == task;
+    });
+
+  statistics.remove(*task);
+  unindexTask(task);
+  tasks.erase(it);
+}
+
+bool TaskManager::addTask(
   const std::string& title,
   const std::string& description,
   const std::string& category,
   const std::string& dueDate,
-  Priority priority) {
+  Priority priority,
+  const Recurrence& recurrence) {
+  PROFILE_SCOPE("TaskManager::addTask");
+  if (nextId > Task::MAX_ID) {
+    return false;
+  }
+
   tasks.push_back(
     std::make_unique<Task>(
       nextId++, title, description, category, dueDate, priority));
+  tasks.back()->setRecurrence(recurrence);
+  indexTask(tasks.back().get());
+  statistics.add(*tasks.back());
+  markModified(tasks.back()->getId());
+  return true;
 }
 
-bool TaskManager::deleteTask(int id) {
-  auto it = std::find_if(
-    tasks.begin(), tasks.end(), [id](const std::unique_ptr<Task>& task) {
-      return task->getId() == id;
-    });
+bool TaskManager::restoreTask(const Task& task) {
+  if (
+    task.getId() < 1 || task.getId() > Task::MAX_ID ||
+    idIndex.count(task.getId())) {
+    return false;
+  }
 
-  if (it != tasks.end()) {
-    tasks.erase(it);
-    return true;
+  insertTask(task);
+  markModified(task.getId());
+  return true;
+}
+
+void TaskManager::applyStoredTask(const Task& task) {
+  Task* existing = getTask(task.getId());
+  if (!existing) {
+    insertTask(task);
+    return;
   }
-  return false;
+
+  bool recategorized = Utils::toLowerCase(task.getCategory()) !=
+                       Utils::toLowerCase(existing->getCategory());
+  statistics.remove(*existing);
+  unindexTask(existing, recategorized);
+  *existing = task;
+  indexTask(existing, recategorized);
+  statistics.add(*existing);
+}
+
+bool TaskManager::removeStoredTask(int id) {
+  Task* task = getTask(id);
+  if (!task) {
+    return false;
+  }
+  eraseTask(task);
+  return true;
+}
+
+int TaskManager::renumberTask(int id) {
+  Task* task = getTask(id);
+  if (!task || nextId > Task::MAX_ID) {
+    return -1;
+  }
+
+  int newId = nextId++;
+  Task moved(*task, newId);
+
+  unindexTask(task);
+  *task = moved;
+  indexTask(task);
+  modifiedIds.erase(id);
+  markModified(newId);
+  return newId;
+}
+
+bool TaskManager::editTask(
+  int id,
+  const std::string& title,
+  const std::string& description,
+  const std::string& category,
+  const std::string& dueDate,
+  Priority priority) {
+  Task* task = getTask(id);
+  if (!task) {
+    return false;
+  }
+
+  bool recategorized =
+    Utils::toLowerCase(category) != Utils::toLowerCase(task->getCategory());
+  statistics.remove(*task);
+  unindexTask(task, recategorized);
+  task->setTitle(title);
+  task->setDescription(description);
+  task->setCategory(category);
+  task->setDueDate(dueDate);
+  task->setPriority(priority);
+  indexTask(task, recategorized);
+  statistics.add(*task);
+  markModified(id);
+  return true;
+}
+
+bool TaskManager::setTaskRecurrence(int id, const Recurrence& recurrence) {
+  Task* task = getTask(id);
+  if (!task) {
+    return false;
+  }
+
+  task->setRecurrence(recurrence);
+  markModified(id);
+  return true;
 }
 
-bool TaskManager::toggleTaskCompletion(int id) {
+bool TaskManager::deleteTask(int id) {
+  PROFILE_SCOPE("TaskManager::deleteTask");
+  Task* task = getTask(id);
+  if (!task) {
+    return false;
+  }
+
+  eraseTask(task);
+  markDeleted(id);
+  return true;
+}
+
+bool TaskManager::toggleTaskCompletion(int id, int* nextOccurrenceId) {
+  PROFILE_SCOPE("TaskManager::toggleTaskCompletion");
+  if (nextOccurrenceId) {
+    *nextOccurrenceId = -1;
+  }
   Task* task = getTask(id);
   if (task) {
     if (task->isCompleted()) {
-      task->markAsIncomplete();
+      reopenTask(task);
     } else {
-      task->markAsCompleted();
+      completeTask(task, nextOccurrenceId);
     }
     return true;
   }
@@ -44,53 +279,403 @@ bool TaskManager::toggleTaskCompletion(int id) {
 }
 
 Task* TaskManager::getTask(int id) {
-  auto it = std::find_if(
-    tasks.begin(), tasks.end(), [id](const std::unique_ptr<Task>& task) {
-      return task->getId() == id;
-    });
-
-  return (it != tasks.end()) ? it->get() : nullptr;
+  auto it = idIndex.find(id);
+  return (it != idIndex.end()) ? it->second : nullptr;
 }
 
 std::vector<Task*> TaskManager::getAllTasks() {
   std::vector<Task*> result;
+  result.reserve(tasks.size());
   for (auto& task : tasks) {
     result.push_back(task.get());
   }
   return result;
 }
 
+void TaskManager::forEachTask(
+  const std::function<void(const Task&)>& visitor) const {
+  for (const auto& task : tasks) {
+    visitor(*task);
+  }
+}
+
 std::vector<Task*> TaskManager::getTasksByCategory(
   const std::string& category) {
-  std::vector<Task*> result;
-  std::string lowerCategory = Utils::toLowerCase(category);
+  PROFILE_SCOPE("TaskManager::getTasksByCategory");
+  auto bucket = categoryIndex.find(Utils::toLowerCase(category));
+  if (bucket == categoryIndex.end()) {
+    return {};
+  }
+  return bucket->second;
+}
 
-  for (auto& task : tasks) {
-    if (Utils::toLowerCase(task->getCategory()) == lowerCategory) {
-      result.push_back(task.get());
+std::vector<Task*> TaskManager::searchTasks(
+  const std::string& keyword,
+  size_t limit) {
+  PROFILE_SCOPE("TaskManager::searchTasks");
+  if (!searchIndex.isBuilt()) {
+    PROFILE_SCOPE("TaskManager::buildSearchIndex");
+    for (const auto& task : tasks) {
+      searchIndex.add(*task);
     }
+    searchIndex.setBuilt(true);
   }
-  return result;
-}
 
-std::vector<Task*> TaskManager::searchTasks(const std::string& keyword) {
   std::vector<Task*> result;
-  std::string lowerKeyword = Utils::toLowerCase(keyword);
-
-  for (auto& task : tasks) {
-    std::string lowerTitle = Utils::toLowerCase(task->getTitle());
-    std::string lowerDesc = Utils::toLowerCase(task->getDescription());
-
-    if (
-      lowerTitle.find(lowerKeyword) != std::string::npos ||
-      lowerDesc.find(lowerKeyword) != std::string::npos) {
-      result.push_back(task.get());
+  for (const SearchHit& hit : searchIndex.search(keyword, limit)) {
+    Task* task = getTask(hit.taskId);
+    if (task) {
+      result.push_back(task);
     }
   }
   return result;
 }
 
 void TaskManager::clearAllTasks() {
+  for (auto& task : tasks) {
+    markDeleted(task->getId());
+  }
   tasks.clear();
+  idIndex.clear();
+  categoryIndex.clear();
+  dueDateIndex.clear();
+  searchIndex.clear();
+  // Ids start over, so what was reported under them no longer applies.
+  scheduler.reset();
+  statistics.clear();
   nextId = 1;
 }
+
+TaskStatistics TaskManager::recomputeStatistics() const {
+  TaskStatistics fresh;
+  for (const auto& task : tasks) {
+    fresh.add(*task);
+  }
+  return fresh;
+}
+
+QueryPlan TaskManager::planQuery(const Query& query) const {
+  QueryPlan plan;
+  plan.source = QuerySource::FULL_SCAN;
+  plan.estimatedCandidates = tasks.size();
+
+  if (query.category) {
+    auto bucket = categoryIndex.find(Utils::toLowerCase(*query.category));
+    size_t size = bucket == categoryIndex.end() ? 0 : bucket->second.size();
+    if (size < plan.estimatedCandidates) {
+      plan.source = QuerySource::CATEGORY_INDEX;
+      plan.estimatedCandidates = size;
+    }
+  }
+
+  if (query.hasDueRange()) {
+    // Count the range only as far as it could still beat the current best.
+    auto first = query.dueFrom ? dueDateIndex.lower_bound(*query.dueFrom)
+                               : dueDateIndex.begin();
+    size_t size = 0;
+    for (auto it = first; it != dueDateIndex.end(); ++it) {
+      if (query.dueTo && it->first > *query.dueTo)
+        break;
+      if (++size >= plan.estimatedCandidates)
+        break;
+    }
+    if (size < plan.estimatedCandidates) {
+      plan.source = QuerySource::DUE_DATE_INDEX;
+      plan.estimatedCandidates = size;
+    }
+  }
+
+  return plan;
+}
+
+size_t TaskManager::runQuery(
+  const Query& query,
+  const std::function<bool(Task*)>& visitor) {
+  PROFILE_SCOPE("TaskManager::runQuery");
+  QueryPlan plan = planQuery(query);
+  std::string needle = query.text ? Utils::toLowerCase(*query.text) : "";
+
+  // Results can be streamed straight to the visitor unless they need
+  // reordering; the due date index already yields them in due date order.
+  bool streaming =
+    query.sortKey == SortKey::NONE ||
+    (plan.source == QuerySource::DUE_DATE_INDEX &&
+     query.sortKey == SortKey::DUE_DATE && !query.descending);
+
+  std::vector<Task*> matches;
+  size_t visited = 0;
+  size_t scanned = 0;
+
+  // Returns false once the caller wants no more candidates.
+  auto consider = [&](Task* task) {
+    scanned++;
+    if (!query.matchesFields(*task))
+      return true;
+    if (query.text && !Query::containsText(*task, needle))
+      return true;
+
+    if (!streaming) {
+      matches.push_back(task);
+      return true;
+    }
+    visited++;
+    if (!visitor(task))
+      return false;
+    return query.limit == 0 || visited < query.limit;
+  };
+
+  switch (plan.source) {
+    case QuerySource::CATEGORY_INDEX: {
+      auto bucket = categoryIndex.find(Utils::toLowerCase(*query.category));
+      if (bucket != categoryIndex.end()) {
+        for (Task* task : bucket->second) {
+          if (!consider(task))
+            break;
+        }
+      }
+      break;
+    }
+    case QuerySource::DUE_DATE_INDEX: {
+      auto it = query.dueFrom ? dueDateIndex.lower_bound(*query.dueFrom)
+                              : dueDateIndex.begin();
+      for (; it != dueDateIndex.end(); ++it) {
+        if (query.dueTo && it->first > *query.dueTo)
+          break;
+        if (!consider(it->second))
+          break;
+      }
+      break;
+    }
+    case QuerySource::FULL_SCAN:
+      for (auto& task : tasks) {
+        if (!consider(task.get()))
+          break;
+      }
+      break;
+  }
+  PROFILE_COUNT("query.scanned", scanned);
+
+  if (streaming) {
+    return visited;
+  }
+
+  auto order = [&query](const Task* a, const Task* b) {
+    return query.comesBefore(*a, *b);
+  };
+  if (query.limit > 0 && query.limit < matches.size()) {
+    std::partial_sort(
+      matches.begin(), matches.begin() + query.limit, matches.end(), order);
+    matches.resize(query.limit);
+  } else {
+    std::sort(matches.begin(), matches.end(), order);
+  }
+
+  for (Task* task : matches) {
+    visited++;
+    if (!visitor(task))
+      break;
+  }
+  return visited;
+}
+
+// Removes many tasks from the indexes at once: each affected category
+// bucket and due date run is compacted in a single pass, instead of being
+// searched once per task.
+void TaskManager::unindexTasks(const std::unordered_set<Task*>& selected) {
+  std::unordered_set<std::string> categories;
+  std::unordered_set<std::string> dueDates;
+  for (Task* task : selected) {
+    idIndex.erase(task->getId());
+    searchIndex.remove(task->getId());
+    categories.insert(Utils::toLowerCase(task->getCategory()));
+    if (!task->getDueDate().empty()) {
+      dueDates.insert(task->getDueDate());
+    }
+  }
+
+  for (const std::string& key : categories) {
+    auto bucket = categoryIndex.find(key);
+    if (bucket == categoryIndex.end())
+      continue;
+    std::vector<Task*>& members = bucket->second;
+    members.erase(
+      std::remove_if(
+        members.begin(),
+        members.end(),
+        [&selected](Task* task) { return selected.count(task) > 0; }),
+      members.end());
+    if (members.empty()) {
+      categoryIndex.erase(bucket);
+    }
+  }
+
+  for (const std::string& dueDate : dueDates) {
+    auto range = dueDateIndex.equal_range(dueDate);
+    for (auto it = range.first; it != range.second;) {
+      it = selected.count(it->second) ? dueDateIndex.erase(it) : std::next(it);
+    }
+  }
+}
+
+std::vector<Task*> TaskManager::resolveSelection(
+  const TaskSelector& selection) {
+  std::vector<Task*> selected;
+
+  if (selection.isQuery()) {
+    runQuery(selection.getQuery(), [&selected](Task* task) {
+      selected.push_back(task);
+      return true;
+    });
+    return selected;
+  }
+
+  long long width = 0;
+  for (const auto& range : selection.getIdRanges()) {
+    width += static_cast<long long>(range.second) - range.first + 1;
+  }
+
+  if (width <= static_cast<long long>(tasks.size())) {
+    for (const auto& range : selection.getIdRanges()) {
+      for (long long id = range.first; id <= range.second; ++id) {
+        auto it = idIndex.find(static_cast<int>(id));
+        if (it != idIndex.end()) {
+          selected.push_back(it->second);
+        }
+      }
+    }
+    // Overlapping ranges may name a task twice.
+    std::sort(selected.begin(), selected.end(), byId);
+    selected.erase(
+      std::unique(selected.begin(), selected.end()), selected.end());
+  } else {
+    for (auto& task : tasks) {
+      if (selection.containsId(task->getId())) {
+        selected.push_back(task.get());
+      }
+    }
+    std::sort(selected.begin(), selected.end(), byId);
+  }
+  // Ids resolve in id order, so bulk operations (and the ids next
+  // occurrences get) do not depend on where tasks sit in memory or in the
+  // task list.
+  return selected;
+}
+
+size_t TaskManager::setTasksCompleted(
+  const TaskSelector& selection,
+  bool completed) {
+  PROFILE_SCOPE("TaskManager::setTasksCompleted");
+  size_t changed = 0;
+  for (Task* task : resolveSelection(selection)) {
+    if (task->isCompleted() == completed)
+      continue;
+    if (completed) {
+      completeTask(task, nullptr);
+    } else {
+      reopenTask(task);
+    }
+    changed++;
+  }
+  return changed;
+}
+
+size_t TaskManager::deleteTasks(const TaskSelector& selection) {
+  PROFILE_SCOPE("TaskManager::deleteTasks");
+  std::vector<Task*> resolved = resolveSelection(selection);
+  if (resolved.empty()) {
+    return 0;
+  }
+  std::unordered_set<Task*> selected(resolved.begin(), resolved.end());
+
+  // Erase-remove compaction: survivors shift down once, and the deleted
+  // tasks are kept alive until the indexes no longer point at them.
+  std::vector<std::unique_ptr<Task>> removed;
+  removed.reserve(selected.size());
+  size_t kept = 0;
+  for (size_t i = 0; i < tasks.size(); ++i) {
+    if (selected.count(tasks[i].get())) {
+      statistics.remove(*tasks[i]);
+      markDeleted(tasks[i]->getId());
+      removed.push_back(std::move(tasks[i]));
+    } else {
+      if (kept != i) {
+        tasks[kept] = std::move(tasks[i]);
+      }
+      kept++;
+    }
+  }
+  tasks.resize(kept);
+
+  unindexTasks(selected);
+  return removed.size();
+}
+
+size_t TaskManager::recategorizeTasks(
+  const TaskSelector& selection,
+  const std::string& category) {
+  PROFILE_SCOPE("TaskManager::recategorizeTasks");
+  std::vector<Task*> changed;
+  for (Task* task : resolveSelection(selection)) {
+    if (task->getCategory() != category) {
+      changed.push_back(task);
+    }
+  }
+
+  unindexTasks(std::unordered_set<Task*>(changed.begin(), changed.end()));
+  for (Task* task : changed) {
+    statistics.remove(*task);
+    task->setCategory(category);
+    statistics.add(*task);
+    indexTask(task);
+    markModified(task->getId());
+  }
+  return changed.size();
+}
+
+size_t TaskManager::reprioritizeTasks(
+  const TaskSelector& selection,
+  Priority priority) {
+  PROFILE_SCOPE("TaskManager::reprioritizeTasks");
+  size_t changed = 0;
+  for (Task* task : resolveSelection(selection)) {
+    if (task->getPriority() == priority)
+      continue;
+    statistics.remove(*task);
+    task->setPriority(priority);
+    statistics.add(*task);
+    markModified(task->getId());
+    changed++;
+  }
+  return changed;
+}
+
+std::vector<Task*> TaskManager::takeDueReminders(const std::string& horizon) {
+  PROFILE_SCOPE("TaskManager::takeDueReminders");
+  // Edits leave stale entries behind; start over once they outnumber the
+  // tasks that could still be due.
+  if (
+    !scheduler.isBuilt() ||
+    scheduler.size() > 2 * dueDateIndex.size() + 1024) {
+    rebuildScheduler();
+  }
+
+  std::vector<Task*> due;
+  auto isCurrent = [this](const ScheduledTask& entry) {
+    Task* task = getTask(entry.taskId);
+    return task && !task->isCompleted() && task->getDueDate() == entry.dueDate;
+  };
+  for (int id : scheduler.takeDue(horizon, isCurrent)) {
+    due.push_back(getTask(id));
+  }
+  return due;
+}
+
+// The due date index is already in order, so every push lands at the
+// bottom of the heap.
+void TaskManager::rebuildScheduler() {
+  scheduler.clear();
+  for (const auto& entry : dueDateIndex) {
+    scheduler.schedule(*entry.second);
+  }
+  scheduler.setBuilt(true);
+}
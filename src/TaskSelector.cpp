@@ -0,0 +1,97 @@
+#include "../include/TaskSelector.h"
+
+#include "../include/Utils.h"
+
+TaskSelector TaskSelector::ids(const std::vector<int>& ids) {
+  TaskSelector selector;
+  for (int id : ids) {
+    selector.idRanges.emplace_back(id, id);
+  }
+  return selector;
+}
+
+TaskSelector TaskSelector::range(int first, int last) {
+  TaskSelector selector;
+  if (first <= last) {
+    selector.idRanges.emplace_back(first, last);
+  }
+  return selector;
+}
+
+TaskSelector TaskSelector::matching(const Query& query) {
+  TaskSelector selector;
+  selector.query = query;
+  selector.byQuery = true;
+  return selector;
+}
+
+bool TaskSelector::containsId(int id) const {
+  for (const auto& range : idRanges) {
+    if (id >= range.first && id <= range.second)
+      return true;
+  }
+  return false;
+}
+
+bool TaskSelector::parse(
+  const std::string& spec,
+  TaskSelector& selector,
+  std::string& error) {
+  std::string trimmed = Utils::trim(spec);
+  if (trimmed.empty()) {
+    error = "Selection cannot be empty";
+    return false;
+  }
+
+  if (trimmed.find_first_not_of("0123456789,- ") != std::string::npos) {
+    Query query;
+    if (!Query::parse(trimmed, query, error))
+      return false;
+    selector = matching(query);
+    return true;
+  }
+
+  selector = TaskSelector();
+  size_t start = 0;
+  while (start <= trimmed.size()) {
+    size_t comma = trimmed.find(',', start);
+    if (comma == std::string::npos)
+      comma = trimmed.size();
+    std::string part = Utils::trim(trimmed.substr(start, comma - start));
+    start = comma + 1;
+
+    if (part.empty())
+      continue;
+
+    size_t dash = part.find('-', 1);
+    std::string first = Utils::trim(part.substr(0, dash));
+    std::string last =
+      dash == std::string::npos ? first : Utils::trim(part.substr(dash + 1));
+    if (!Utils::isValidInteger(first) || !Utils::isValidInteger(last)) {
+      error = "Invalid id or range: " + part;
+      return false;
+    }
+
+    long long low = 0;
+    long long high = 0;
+    if (
+      !Utils::parseInt64(first, low) || !Utils::parseInt64(last, high) ||
+      low < 1 || high > Task::MAX_ID) {
+      error = "Id out of range (1-" + std::to_string(Task::MAX_ID) +
+              "): " + part;
+      return false;
+    }
+    if (low > high) {
+      error = "Range is reversed: " + part;
+      return false;
+    }
+    selector.idRanges.emplace_back(
+      static_cast<int>(low), static_cast<int>(high));
+  }
+
+  if (selector.idRanges.empty()) {
+    error = "Selection cannot be empty";
+    return false;
+  }
+  return true;
+}
@@ -0,0 +1,115 @@
+#include "../include/TaskStatistics.h"
+
+#include "../include/Utils.h"
+
+TaskStatistics::TaskStatistics() : total(0), completed(0), priorityCounts{} {}
+
+static void adjust(
+  std::map<std::string, int>& counts,
+  const std::string& key,
+  int delta) {
+  int& count = counts[key];
+  count += delta;
+  if (count <= 0) {
+    counts.erase(key);
+  }
+}
+
+void TaskStatistics::apply(const Task& task, int delta) {
+  total += delta;
+  int priority = static_cast<int>(task.getPriority());
+  if (priority >= 0 && priority < 3) {
+    priorityCounts[priority] += delta;
+  }
+
+  std::string key = Utils::toLowerCase(task.getCategory());
+  CategoryStats& category = categories[key];
+  if (category.name.empty()) {
+    category.name = task.getCategory();
+  }
+  category.total += delta;
+
+  if (task.isCompleted()) {
+    completed += delta;
+    category.completed += delta;
+    adjust(completedByDay, Utils::formatDate(task.getCompletedAt()), delta);
+  } else if (!task.getDueDate().empty()) {
+    adjust(pendingByDueDate, task.getDueDate(), delta);
+  }
+
+  if (category.total <= 0) {
+    categories.erase(key);
+  }
+
+  adjust(createdByDay, Utils::formatDate(task.getCreatedAt()), delta);
+}
+
+void TaskStatistics::add(const Task& task) {
+  apply(task, 1);
+}
+
+void TaskStatistics::remove(const Task& task) {
+  apply(task, -1);
+}
+
+void TaskStatistics::clear() {
+  *this = TaskStatistics();
+}
+
+int TaskStatistics::getPriorityCount(Priority priority) const {
+  int index = static_cast<int>(priority);
+  return (index >= 0 && index < 3) ? priorityCounts[index] : 0;
+}
+
+double TaskStatistics::getCompletionRate() const {
+  return total == 0 ? 0.0 : 100.0 * completed / total;
+}
+
+int TaskStatistics::countOverdue(const std::string& today) const {
+  int overdue = 0;
+  for (auto it = pendingByDueDate.begin();
+       it != pendingByDueDate.end() && it->first < today;
+       ++it) {
+    overdue += it->second;
+  }
+  return overdue;
+}
+
+int TaskStatistics::getCreatedOn(const std::string& day) const {
+  auto it = createdByDay.find(day);
+  return it != createdByDay.end() ? it->second : 0;
+}
+
+int TaskStatistics::getCompletedOn(const std::string& day) const {
+  auto it = completedByDay.find(day);
+  return it != completedByDay.end() ? it->second : 0;
+}
+
+bool TaskStatistics::operator==(const TaskStatistics& other) const {
+  if (
+    total != other.total || completed != other.completed ||
+    pendingByDueDate != other.pendingByDueDate ||
+    createdByDay != other.createdByDay ||
+    completedByDay != other.completedByDay ||
+    categories.size() != other.categories.size()) {
+    return false;
+  }
+
+  for (int i = 0; i < 3; ++i) {
+    if (priorityCounts[i] != other.priorityCounts[i])
+      return false;
+  }
+
+  // Display names depend on which spelling was seen first, so only the
+  // counts are compared.
+  for (auto it = categories.begin(), jt = other.categories.begin();
+       it != categories.end();
+       ++it, ++jt) {
+    if (
+      it->first != jt->first || it->second.total != jt->second.total ||
+      it->second.completed != jt->second.completed) {
+      return false;
+    }
+  }
+  return true;
+}
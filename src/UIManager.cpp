@@ -1,9 +1,14 @@
 #include "../include/UIManager.h"
 
+#include <algorithm>
+#include <cstdint>
 #include <ctime>
 #include <iomanip>
 #include <iostream>
 
+#include "../include/Profiler.h"
+#include "../include/Utils.h"
+
 #ifdef _WIN32
 #include <windows.h>
 #else
@@ -31,36 +36,224 @@ void UIManager::clearScreen() {
 int UIManager::getTerminalWidth() {
 #ifdef _WIN32
   CONSOLE_SCREEN_BUFFER_INFO csbi;
-  GetConsoleScreenBufferInfo(GetStdHandle(STD_OUTPUT_HANDLE), &csbi);
+  if (!GetConsoleScreenBufferInfo(GetStdHandle(STD_OUTPUT_HANDLE), &csbi))
+    return 0;
   return csbi.srWindow.Right - csbi.srWindow.Left + 1;
 #else
   struct winsize w;
-  ioctl(STDOUT_FILENO, TIOCGWINSZ, &w);
+  if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &w) != 0)
+    return 0;
   return w.ws_col;
 #endif
 }
 
-void UIManager::printHeader(const std::string& title) {
+int UIManager::getTerminalHeight() {
+#ifdef _WIN32
+  CONSOLE_SCREEN_BUFFER_INFO csbi;
+  if (!GetConsoleScreenBufferInfo(GetStdHandle(STD_OUTPUT_HANDLE), &csbi))
+    return 0;
+  return csbi.srWindow.Bottom - csbi.srWindow.Top + 1;
+#else
+  struct winsize w;
+  if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &w) != 0)
+    return 0;
+  return w.ws_row;
+#endif
+}
+
+const std::vector<std::string>& UIManager::renderHeader(
+  const std::string& title) {
+  // The box only changes with the title or the terminal width, so it is
+  // built once and reused by every redraw.
+  static std::vector<std::string> lines;
+  static std::string cachedTitle;
+  static int cachedWidth = 0;
+
   int width = getTerminalWidth();
   if (width < 20)
     width = 80;  // fallback
+  if (width == cachedWidth && title == cachedTitle && !lines.empty())
+    return lines;
 
-  std::string boxLine = "";
+  std::string boxLine;
   for (int i = 0; i < width - 2; i++) {
     boxLine += "═";
   }
 
-  std::string top = "╔" + boxLine + "╗";
-  std::string bottom = "╚" + boxLine + "╝";
+  int room = width - 4;
+  std::string shownTitle = truncateToWidth(title, room);
+  int titleWidth = static_cast<int>(displayWidth(shownTitle));
+  int padding = (room - titleWidth) / 2;
+  std::string middle = "║ " + std::string(padding, ' ') + shownTitle +
+                       std::string(room - padding - titleWidth, ' ') + " ║";
+
+  lines = {
+    "",
+    BOLD CYAN "╔" + boxLine + "╗" RESET,
+    BOLD CYAN + middle + RESET,
+    BOLD CYAN "╚" + boxLine + "╝" RESET,
+    ""};
+  cachedTitle = title;
+  cachedWidth = width;
+  return lines;
+}
+
+void UIManager::printHeader(const std::string& title) {
+  PROFILE_SCOPE("UIManager::printHeader");
+  for (const std::string& line : renderHeader(title)) {
+    std::cout << line << "\n";
+  }
+}
+
+static const char* const REPLACEMENT = "\xEF\xBF\xBD";  // U+FFFD
+
+// Decodes the UTF-8 sequence at `pos` and moves past it. A malformed byte is
+// consumed on its own and decodes as U+FFFD.
+static uint32_t nextCodePoint(const std::string& text, size_t& pos) {
+  unsigned char lead = static_cast<unsigned char>(text[pos++]);
+  if (lead < 0x80)
+    return lead;
+
+  // Continuation bytes after the lead byte, and the smallest code point
+  // that needs them.
+  size_t length;
+  uint32_t minimum;
+  if ((lead & 0xE0) == 0xC0) {
+    length = 1;
+    minimum = 0x80;
+  } else if ((lead & 0xF0) == 0xE0) {
+    length = 2;
+    minimum = 0x800;
+  } else if ((lead & 0xF8) == 0xF0) {
+    length = 3;
+    minimum = 0x10000;
+  } else {
+    return 0xFFFD;
+  }
+
+  uint32_t codePoint = lead & (0x3F >> length);
+
+  if (text.size() - pos < length)
+    return 0xFFFD;
+  for (size_t i = 0; i < length; ++i) {
+    unsigned char c = static_cast<unsigned char>(text[pos + i]);
+    if ((c & 0xC0) != 0x80)
+      return 0xFFFD;
+    codePoint = (codePoint << 6) | (c & 0x3F);
+  }
+  // Overlong forms, surrogates and values past U+10FFFF are not characters.
+  if (
+    codePoint < minimum || codePoint > 0x10FFFF ||
+    (codePoint >= 0xD800 && codePoint <= 0xDFFF)) {
+    return 0xFFFD;
+  }
+  pos += length;
+  return codePoint;
+}
+
+struct CodePointRange {
+  uint32_t first;
+  uint32_t last;
+};
+
+// Combining marks, zero-width spaces and joiners, and variation selectors.
+static const CodePointRange ZERO_WIDTH[] = {
+  {0x0300, 0x036F}, {0x0483, 0x0489}, {0x0591, 0x05BD}, {0x0610, 0x061A},
+  {0x064B, 0x065F}, {0x1AB0, 0x1AFF}, {0x1DC0, 0x1DFF}, {0x200B, 0x200F},
+  {0x20D0, 0x20FF}, {0xFE00, 0xFE0F}, {0xFE20, 0xFE2F}, {0xE0100, 0xE01EF}};
+
+// East Asian Wide and Fullwidth characters and emoji, which terminals draw
+// two columns wide.
+static const CodePointRange DOUBLE_WIDTH[] = {
+  {0x1100, 0x115F}, {0x231A, 0x231B}, {0x2329, 0x232A}, {0x23E9, 0x23EC},
+  {0x23F0, 0x23F0}, {0x23F3, 0x23F3}, {0x25FD, 0x25FE}, {0x2614, 0x2615},
+  {0x2648, 0x2653}, {0x267F, 0x267F}, {0x2693, 0x2693}, {0x26A1, 0x26A1},
+  {0x26AA, 0x26AB}, {0x26BD, 0x26BE}, {0x26C4, 0x26C5}, {0x26CE, 0x26CE},
+  {0x26D4, 0x26D4}, {0x26EA, 0x26EA}, {0x26F2, 0x26F3}, {0x26F5, 0x26F5},
+  {0x26FA, 0x26FA}, {0x26FD, 0x26FD}, {0x2705, 0x2705}, {0x270A, 0x270B},
+  {0x2728, 0x2728}, {0x274C, 0x274C}, {0x274E, 0x274E}, {0x2753, 0x2755},
+  {0x2757, 0x2757}, {0x2795, 0x2797}, {0x27B0, 0x27B0}, {0x27BF, 0x27BF},
+  {0x2B1B, 0x2B1C}, {0x2B50, 0x2B50}, {0x2B55, 0x2B55}, {0x2E80, 0x303E},
+  {0x3041, 0x33FF}, {0x3400, 0x4DBF}, {0x4E00, 0x9FFF}, {0xA000, 0xA4CF},
+  {0xA960, 0xA97F}, {0xAC00, 0xD7A3}, {0xF900, 0xFAFF}, {0xFE10, 0xFE19},
+  {0xFE30, 0xFE6F}, {0xFF00, 0xFF60}, {0xFFE0, 0xFFE6}, {0x16FE0, 0x18CFF},
+  {0x1B000, 0x1B2FF}, {0x1F004, 0x1F004}, {0x1F0CF, 0x1F0CF},
+  {0x1F18E, 0x1F18E}, {0x1F191, 0x1F19A}, {0x1F200, 0x1F251},
+  {0x1F300, 0x1F64F}, {0x1F680, 0x1F6FF}, {0x1F7E0, 0x1F7EB},
+  {0x1F90C, 0x1F9FF}, {0x1FA70, 0x1FAFF}, {0x20000, 0x3FFFD}};
 
-  int padding = (width - 4 - title.length()) / 2;
-  std::string middle = "║ " + std::string(padding, ' ') + title +
-                       std::string(width - 4 - padding - title.length(), ' ') +
-                       " ║";
+template <size_t N>
+static bool inRanges(const CodePointRange (&ranges)[N], uint32_t codePoint) {
+  // Sorted and disjoint: the only candidate is the last range starting at or
+  // before the code point.
+  const CodePointRange* next = std::upper_bound(
+    ranges,
+    ranges + N,
+    codePoint,
+    [](uint32_t value, const CodePointRange& range) {
+      return value < range.first;
+    });
+  return next != ranges && codePoint <= (next - 1)->last;
+}
 
-  std::cout << "\n" << BOLD << CYAN << top << "\n";
-  std::cout << middle << "\n";
-  std::cout << bottom << RESET << "\n\n";
+static size_t codePointWidth(uint32_t codePoint) {
+  if (codePoint < 0x0300)
+    return 1;
+  if (inRanges(ZERO_WIDTH, codePoint))
+    return 0;
+  return inRanges(DOUBLE_WIDTH, codePoint) ? 2 : 1;
+}
+
+// Control characters (C0, DEL and C1) and malformed UTF-8 are replaced,
+// so a title cannot move the cursor, restyle the terminal or break the row
+// layout.
+std::string UIManager::printable(const std::string& text) {
+  bool plain = std::all_of(text.begin(), text.end(), [](char c) {
+    return c >= 0x20 && c < 0x7F;
+  });
+  if (plain)
+    return text;
+
+  std::string out;
+  for (size_t pos = 0; pos < text.size();) {
+    size_t start = pos;
+    uint32_t codePoint = nextCodePoint(text, pos);
+    if (
+      codePoint < 0x20 || (codePoint >= 0x7F && codePoint < 0xA0) ||
+      codePoint == 0xFFFD) {
+      out += REPLACEMENT;
+    } else {
+      out.append(text, start, pos - start);
+    }
+  }
+  return out;
+}
+
+size_t UIManager::displayWidth(const std::string& text) {
+  size_t width = 0;
+  for (size_t pos = 0; pos < text.size();) {
+    width += codePointWidth(nextCodePoint(text, pos));
+  }
+  return width;
+}
+
+std::string UIManager::truncateToWidth(const std::string& text, size_t width) {
+  if (displayWidth(text) <= width)
+    return text;
+  if (width == 0)
+    return "";
+
+  // Keep what fits in width - 1 columns and mark the cut with an ellipsis;
+  // a wide character that would straddle the limit is dropped whole.
+  size_t end = 0;
+  size_t used = 0;
+  for (size_t pos = 0; pos < text.size();) {
+    used += codePointWidth(nextCodePoint(text, pos));
+    if (used > width - 1)
+      break;
+    end = pos;
+  }
+  return text.substr(0, end) + "…";
 }
 
 std::string UIManager::getColorCode(Priority priority) {
@@ -86,25 +279,34 @@ std::string UIManager::formatTimestamp(time_t timestamp) {
   return std::string(buffer);
 }
 
-void UIManager::printTask(const Task* task, int displayIndex) {
+void UIManager::printTask(const Task* task, int number) {
   std::string colorCode = getColorCode(task->getPriority());
   std::string statusMark = task->isCompleted() ? GREEN "[✓]" RESET : "[ ]";
 
-  std::cout << displayIndex << ". " << statusMark << " " << colorCode << BOLD
-            << task->getTitle() << RESET << "\n";
+  std::cout << number << ". " << statusMark << " " << colorCode << BOLD
+            << printable(task->getTitle()) << RESET << "\n";
 
-  if (!task->getDescription().empty()) {
-    std::cout << "   Description: " << task->getDescription() << "\n";
+  // A description may span lines; each is printed on its own, indented.
+  const std::string& description = task->getDescription();
+  for (size_t start = 0; start < description.size();) {
+    size_t end = std::min(description.find('\n', start), description.size());
+    std::cout << (start == 0 ? "   Description: " : "                ")
+              << printable(description.substr(start, end - start)) << "\n";
+    start = end + 1;
   }
 
-  std::cout << "   Category: " << MAGENTA << task->getCategory() << RESET
-            << " | Priority: " << colorCode << task->priorityToString()
-            << RESET;
+  std::cout << "   Category: " << MAGENTA << printable(task->getCategory())
+            << RESET << " | Priority: " << colorCode
+            << task->priorityToString() << RESET;
 
   if (!task->getDueDate().empty()) {
     std::cout << " | Due: " << CYAN << task->getDueDate() << RESET;
   }
 
+  if (task->getRecurrence().isRecurring()) {
+    std::cout << " | Repeats: " << task->getRecurrence().toString();
+  }
+
   std::cout << "\n   Created: " << formatTimestamp(task->getCreatedAt());
 
   if (task->isCompleted()) {
@@ -114,14 +316,45 @@ void UIManager::printTask(const Task* task, int displayIndex) {
   std::cout << "\n\n";
 }
 
+std::string UIManager::formatTaskRow(const Task* task, int width) {
+  size_t columns = width > 0 ? static_cast<size_t>(width) : 80;
+  std::string id = " #" + std::to_string(task->getId()) + " ";
+  std::string details =
+    "  (" + printable(task->getCategory()) + " | " + task->priorityToString();
+  if (!task->getDueDate().empty()) {
+    details += " | Due: " + task->getDueDate();
+  }
+  if (task->getRecurrence().isRecurring()) {
+    details += " | Repeats: " + task->getRecurrence().toString();
+  }
+  details += ")";
+
+  // The id and "[ ] " come first; the details are dropped rather than cut
+  // the title down to less than a dozen columns.
+  size_t used = displayWidth(id) + 4;
+  if (used + 12 + displayWidth(details) > columns) {
+    details.clear();
+  }
+  used += displayWidth(details);
+  std::string title = truncateToWidth(
+    printable(task->getTitle()), columns > used ? columns - used : 0);
+
+  std::string statusMark = task->isCompleted() ? GREEN "[✓]" RESET : "[ ]";
+  return id + statusMark + " " + getColorCode(task->getPriority()) + BOLD +
+         title + RESET + details;
+}
+
 void UIManager::printTaskList(const std::vector<Task*>& tasks) {
+  PROFILE_SCOPE("UIManager::printTaskList");
   if (tasks.empty()) {
     printInfo("No tasks found.");
     return;
   }
 
-  for (size_t i = 0; i < tasks.size(); ++i) {
-    printTask(tasks[i], i + 1);
+  // Numbered by id: results may come in any order (ranked, sorted), and
+  // toggle, delete and edit take ids.
+  for (Task* task : tasks) {
+    printTask(task, task->getId());
   }
 }
 
@@ -134,9 +367,79 @@ void UIManager::printMenu() {
   std::cout << " 5. Delete Task\n";
   std::cout << " 6. Search Tasks\n";
   std::cout << " 7. Clear All Tasks\n";
+  std::cout << " 8. Performance Stats\n";
+  std::cout << " 9. Task Statistics\n";
+  std::cout << "10. Edit Task\n";
+  std::cout << "11. Query Tasks\n";
+  std::cout << "12. Bulk Operations\n";
   std::cout << " 0. Exit\n\n";
 }
 
+void UIManager::printStatistics(const TaskStatistics& stats) {
+  PROFILE_SCOPE("UIManager::printStatistics");
+  std::cout << BOLD << "Overview" << RESET << "\n";
+  std::cout << "   Total: " << stats.getTotal() << " | Completed: " << GREEN
+            << stats.getCompleted() << RESET
+            << " | Pending: " << stats.getPending() << " | Overdue: " << RED
+            << stats.countOverdue(Utils::today()) << RESET << "\n";
+  std::cout << "   Completion rate: " << std::fixed << std::setprecision(1)
+            << stats.getCompletionRate() << std::defaultfloat << "%\n\n";
+
+  std::cout << BOLD << "By Priority" << RESET << "\n";
+  std::cout << "   " << RED
+            << "High: " << stats.getPriorityCount(Priority::HIGH) << RESET
+            << " | " << YELLOW
+            << "Medium: " << stats.getPriorityCount(Priority::MEDIUM) << RESET
+            << " | " << GREEN
+            << "Low: " << stats.getPriorityCount(Priority::LOW) << RESET
+            << "\n\n";
+
+  std::cout << BOLD << "By Category" << RESET << "\n";
+  if (stats.getCategories().empty()) {
+    std::cout << "   (none)\n";
+  }
+  for (const auto& entry : stats.getCategories()) {
+    const CategoryStats& category = entry.second;
+    // Padded by display width; setw counts bytes.
+    std::string name = truncateToWidth(printable(category.name), 20);
+    std::cout << "   " << MAGENTA << name
+              << std::string(20 - displayWidth(name), ' ') << RESET
+              << std::setw(5) << category.completed << "/" << category.total
+              << " done\n";
+  }
+
+  std::cout << "\n"
+            << BOLD << "Last 7 Days (created / completed)" << RESET << "\n";
+  // Stepped by calendar day: a DST change makes some days 23 or 25 hours.
+  long today = 0;
+  Utils::dateToDays(Utils::today(), today);
+  for (long daysAgo = 6; daysAgo >= 0; --daysAgo) {
+    std::string day = Utils::daysToDate(today - daysAgo);
+    std::cout << "   " << CYAN << day << RESET << "  " << std::setw(4)
+              << stats.getCreatedOn(day) << " / " << stats.getCompletedOn(day)
+              << "\n";
+  }
+  std::cout << "\n";
+}
+
+void UIManager::printReminders(
+  const std::vector<Task*>& tasks,
+  const std::string& today) {
+  const size_t shown = 5;
+  std::cout << YELLOW << BOLD << "⏰ " << tasks.size() << " task(s) due"
+            << RESET << "\n";
+  for (size_t i = 0; i < tasks.size() && i < shown; ++i) {
+    const std::string& due = tasks[i]->getDueDate();
+    std::cout << "   #" << tasks[i]->getId() << " "
+              << printable(tasks[i]->getTitle()) << " ("
+              << (due < today ? RED : CYAN) << due << RESET << ")\n";
+  }
+  if (tasks.size() > shown) {
+    std::cout << "   ...and " << tasks.size() - shown << " more\n";
+  }
+  std::cout << "\n";
+}
+
 void UIManager::printSuccess(const std::string& message) {
   std::cout << GREEN << "✓ " << message << RESET << "\n";
 }
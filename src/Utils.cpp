@@ -2,7 +2,13 @@
 
 #include <algorithm>
 #include <cctype>
-#include <regex>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <iterator>
+#include <map>
+#include <stdexcept>
 
 bool Utils::isValidInteger(const std::string& str) {
   if (str.empty())
@@ -26,11 +32,21 @@ bool Utils::isValidInteger(const std::string& str) {
 int Utils::stringToInt(const std::string& str) {
   try {
     return std::stoi(str);
-  } catch (...) {
+  } catch (const std::logic_error&) {
+    // invalid_argument or out_of_range
     return -1;
   }
 }
 
+bool Utils::parseInt64(const std::string& str, long long& value) {
+  if (str.empty() || std::isspace(static_cast<unsigned char>(str[0])))
+    return false;
+  errno = 0;
+  char* end = nullptr;
+  value = std::strtoll(str.c_str(), &end, 10);
+  return errno == 0 && end == str.c_str() + str.size();
+}
+
 Priority Utils::stringToPriority(const std::string& str) {
   std::string lower = toLowerCase(str);
 
@@ -61,7 +77,135 @@ std::string Utils::toLowerCase(const std::string& str) {
   return result;
 }
 
+bool Utils::equalsIgnoreCase(const std::string& a, const std::string& b) {
+  return a.size() == b.size() &&
+         std::equal(a.begin(), a.end(), b.begin(), [](char x, char y) {
+           return std::tolower(static_cast<unsigned char>(x)) ==
+                  std::tolower(static_cast<unsigned char>(y));
+         });
+}
+
 bool Utils::isValidDate(const std::string& date) {
-  std::regex datePattern(R"(\d{4}-\d{2}-\d{2})");
-  return std::regex_match(date, datePattern);
+  // Equivalent to matching \d{4}-\d{2}-\d{2}, without compiling a regex on
+  // every call (this runs once per record on import).
+  if (date.size() != 10 || date[4] != '-' || date[7] != '-')
+    return false;
+
+  for (size_t i = 0; i < date.size(); ++i) {
+    if (i != 4 && i != 7 && !std::isdigit(static_cast<unsigned char>(date[i])))
+      return false;
+  }
+  return true;
+}
+
+namespace {
+struct DayWindow {
+  time_t end;
+  std::string date;
+};
+}  // namespace
+
+std::string Utils::formatDate(time_t timestamp) {
+  // localtime() and mktime() are comparatively expensive (glibc rereads the
+  // zone file on every call), while bulk loads format many timestamps from
+  // relatively few days. So each day seen is cached as the span from its
+  // local midnight to the next, as mktime() reports them, which keeps the
+  // 23- and 25-hour days around DST changes exact.
+  static const size_t MAX_CACHED_DAYS = 4096;
+  static std::map<time_t, DayWindow> days;  // keyed on local midnight
+  static std::string zone;
+
+  const char* currentZone = std::getenv("TZ");
+  if (zone != (currentZone ? currentZone : "")) {
+    days.clear();
+    zone = currentZone ? currentZone : "";
+  }
+  auto after = days.upper_bound(timestamp);
+  if (after != days.begin() && timestamp < std::prev(after)->second.end) {
+    return std::prev(after)->second.date;
+  }
+
+  char buffer[16];
+  struct tm* timeinfo = localtime(&timestamp);
+  if (!timeinfo || !strftime(buffer, sizeof(buffer), "%Y-%m-%d", timeinfo)) {
+    return "";
+  }
+
+  struct tm midnight = *timeinfo;
+  midnight.tm_hour = 0;
+  midnight.tm_min = 0;
+  midnight.tm_sec = 0;
+  midnight.tm_isdst = -1;
+  struct tm nextMidnight = midnight;
+  nextMidnight.tm_mday += 1;
+  time_t start = mktime(&midnight);
+  time_t end = mktime(&nextMidnight);
+
+  if (start != -1 && end != -1 && start <= timestamp && timestamp < end) {
+    if (days.size() >= MAX_CACHED_DAYS) {
+      days.clear();
+    }
+    days[start] = DayWindow{end, buffer};
+  }
+  return buffer;
+}
+
+std::string Utils::today() {
+  return formatDate(time(nullptr));
+}
+
+int Utils::daysInMonth(int year, int month) {
+  static const int DAYS[] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+  if (month < 1 || month > 12)
+    return 0;
+  bool leap = (year % 4 == 0 && year % 100 != 0) || year % 400 == 0;
+  return DAYS[month - 1] + (month == 2 && leap ? 1 : 0);
+}
+
+// Conversions between civil dates and day numbers follow Howard Hinnant's
+// days_from_civil / civil_from_days, which need no time zone or libc calls.
+bool Utils::dateToDays(const std::string& date, long& days) {
+  if (!isValidDate(date))
+    return false;
+
+  long year = std::stol(date.substr(0, 4));
+  int month = std::stoi(date.substr(5, 2));
+  int day = std::stoi(date.substr(8, 2));
+  if (day < 1 || day > daysInMonth(static_cast<int>(year), month))
+    return false;
+
+  year -= month <= 2;
+  long era = (year >= 0 ? year : year - 399) / 400;
+  long yearOfEra = year - era * 400;
+  long dayOfYear = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+  long dayOfEra =
+    yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+  days = era * 146097 + dayOfEra - 719468;
+  return true;
+}
+
+std::string Utils::daysToDate(long days) {
+  days += 719468;
+  long era = (days >= 0 ? days : days - 146096) / 146097;
+  long dayOfEra = days - era * 146097;
+  long yearOfEra =
+    (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+  long dayOfYear =
+    dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+  long shifted = (5 * dayOfYear + 2) / 153;
+  long day = dayOfYear - (153 * shifted + 2) / 5 + 1;
+  long month = shifted < 10 ? shifted + 3 : shifted - 9;
+  long year = yearOfEra + era * 400 + (month <= 2);
+
+  if (year < 0 || year > 9999)
+    return "";
+  char buffer[32];
+  snprintf(
+    buffer,
+    sizeof(buffer),
+    "%04d-%02d-%02d",
+    static_cast<int>(year),
+    static_cast<int>(month),
+    static_cast<int>(day));
+  return buffer;
 }
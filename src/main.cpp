@@ -1,14 +1,21 @@
+#include <algorithm>
+#include <chrono>
+#include <functional>
 #include <iostream>
 #include <limits>
+#include <thread>
 
+#include "../include/DataExchange.h"
 #include "../include/FileHandler.h"
+#include "../include/Profiler.h"
+#include "../include/Screen.h"
 #include "../include/Task.h"
 #include "../include/TaskManager.h"
 #include "../include/UIManager.h"
 #include "../include/Utils.h"
 
 void addTaskFlow(TaskManager& manager) {
-  std::string title, description, category, dueDate, priorityStr;
+  std::string title, description, category, dueDate, priorityStr, repeat;
 
   std::cout << "Enter task title: ";
   std::getline(std::cin, title);
@@ -42,19 +49,151 @@ void addTaskFlow(TaskManager& manager) {
   std::getline(std::cin, priorityStr);
   Priority priority = Utils::stringToPriority(priorityStr);
 
-  manager.addTask(title, description, category, dueDate, priority);
+  std::cout << "Repeat (daily, weekly:mon,fri, monthly, cron:<days> <months> "
+               "<weekdays>; optional): ";
+  std::getline(std::cin, repeat);
+  Recurrence recurrence;
+  std::string error;
+  if (!Recurrence::parse(repeat, recurrence, error)) {
+    UIManager::printError(error + ". The task will not repeat.");
+    recurrence = Recurrence();
+  }
+
+  bool added = manager.addTask(
+    title, description, category, dueDate, priority, recurrence);
+  if (!added) {
+    UIManager::printError("No task ids left. Delete or clear tasks first.");
+    return;
+  }
   UIManager::printSuccess("Task added successfully!");
 }
 
-void viewAllTasksFlow(TaskManager& manager) {
-  UIManager::clearScreen();
-  UIManager::printHeader("ALL TASKS");
+// A completed task that still has its rule could not hand it on.
+bool nextOccurrenceFailed(TaskManager& manager, int taskId) {
+  Task* task = manager.getTask(taskId);
+  return task && task->isCompleted() && task->getRecurrence().isRecurring();
+}
 
-  std::vector<Task*> tasks = manager.getAllTasks();
-  UIManager::printTaskList(tasks);
+// Paged task list drawn through a Screen, with tasks toggled in place and
+// "d <id>" opening a task's full details. Each redraw rewrites only the rows
+// that changed, so toggling a task costs the same however long the list is.
+// Returns true if any task was toggled.
+bool browseTasksFlow(
+  TaskManager& manager,
+  const std::string& title,
+  const std::function<std::vector<Task*>()>& listTasks) {
+  Screen screen;
+  std::vector<Task*> tasks = listTasks();
+  size_t page = 0;
+  std::string status;
+  bool toggled = false;
+
+  while (true) {
+    int width = UIManager::getTerminalWidth();
+    int height = UIManager::getTerminalHeight();
+    if (width < 20)
+      width = 80;  // fallback
+    if (height < 12)
+      height = 24;
+    screen.setSize(width, height);
+
+    std::vector<std::string> frame = UIManager::renderHeader(title);
+    // Three rows for the footer and two for the prompt and the row its input
+    // ends on, so the terminal never scrolls the frame.
+    size_t pageSize = static_cast<size_t>(height) - frame.size() - 5;
+    size_t pageCount =
+      std::max<size_t>(1, (tasks.size() + pageSize - 1) / pageSize);
+    page = std::min(page, pageCount - 1);
+
+    size_t first = page * pageSize;
+    size_t last = std::min(tasks.size(), first + pageSize);
+    for (size_t i = first; i < last; ++i) {
+      frame.push_back(UIManager::formatTaskRow(tasks[i], width));
+    }
+    if (tasks.empty()) {
+      frame.push_back(" No tasks found.");
+    }
+    frame.push_back("");
+    frame.push_back(UIManager::truncateToWidth(
+      " Page " + std::to_string(page + 1) + " of " +
+        std::to_string(pageCount) + " (" + std::to_string(tasks.size()) +
+        " tasks)  " + status,
+      width));
+    frame.push_back(UIManager::truncateToWidth(
+      " <id> toggle | d <id> details | Enter/n next page | p previous page"
+      " | q back",
+      width));
+    screen.present(frame);
+
+    std::cout << "> " << std::flush;
+    std::string input;
+    if (!std::getline(std::cin, input))
+      break;
+    // Input that wraps onto another row scrolls the frame out of place.
+    if (2 + UIManager::displayWidth(input) >= static_cast<size_t>(width)) {
+      screen.invalidate();
+    }
+    input = Utils::toLowerCase(Utils::trim(input));
+    status.clear();
+
+    if (input == "q")
+      break;
+    if (input.empty() || input == "n") {
+      page = std::min(page + 1, pageCount - 1);
+      continue;
+    }
+    if (input == "p") {
+      page = page > 0 ? page - 1 : 0;
+      continue;
+    }
+    if (input.size() > 1 && input[0] == 'd') {
+      std::string idText = Utils::trim(input.substr(1));
+      Task* task = Utils::isValidInteger(idText)
+                     ? manager.getTask(Utils::stringToInt(idText))
+                     : nullptr;
+      if (!task) {
+        status = "Task #" + idText + " not found.";
+        continue;
+      }
+      // Drawn outside the retained frame, which is redrawn afterwards.
+      UIManager::clearScreen();
+      UIManager::printHeader("TASK #" + std::to_string(task->getId()));
+      UIManager::printTask(task, task->getId());
+      UIManager::waitForEnter();
+      screen.invalidate();
+      continue;
+    }
+    if (!Utils::isValidInteger(input)) {
+      status = "Unknown command: " + input;
+      continue;
+    }
+
+    int taskId = Utils::stringToInt(input);
+    int nextOccurrenceId = -1;
+    if (!manager.toggleTaskCompletion(taskId, &nextOccurrenceId)) {
+      status = "Task #" + input + " not found.";
+      continue;
+    }
+    toggled = true;
+    status = "Toggled #" + std::to_string(taskId) + ".";
+    Task* next = manager.getTask(nextOccurrenceId);
+    if (next) {
+      status += " Next occurrence is #" + std::to_string(next->getId()) +
+                ", due " + next->getDueDate() + ".";
+      tasks = listTasks();
+    } else if (nextOccurrenceFailed(manager, taskId)) {
+      status += " No task ids left for the next occurrence.";
+    }
+  }
+  return toggled;
+}
+
+bool viewAllTasksFlow(TaskManager& manager) {
+  return browseTasksFlow(
+    manager, "ALL TASKS", [&manager]() { return manager.getAllTasks(); });
 }
 
-void viewByCategoryFlow(TaskManager& manager) {
+bool viewByCategoryFlow(TaskManager& manager) {
   std::string category;
 
   std::cout << "Enter category name: ";
@@ -63,14 +202,14 @@ void viewByCategoryFlow(TaskManager& manager) {
 
   if (category.empty()) {
     UIManager::printError("Category name cannot be empty!");
-    return;
+    UIManager::waitForEnter();
+    return false;
   }
 
-  UIManager::clearScreen();
-  UIManager::printHeader("TASKS IN CATEGORY: " + category);
-
-  std::vector<Task*> tasks = manager.getTasksByCategory(category);
-  UIManager::printTaskList(tasks);
+  return browseTasksFlow(
+    manager, "TASKS IN CATEGORY: " + category, [&manager, &category]() {
+      return manager.getTasksByCategory(category);
+    });
 }
 
 void toggleTaskFlow(TaskManager& manager) {
@@ -85,9 +224,19 @@ void toggleTaskFlow(TaskManager& manager) {
   }
 
   int taskId = Utils::stringToInt(idStr);
+  int nextOccurrenceId = -1;
 
-  if (manager.toggleTaskCompletion(taskId)) {
+  if (manager.toggleTaskCompletion(taskId, &nextOccurrenceId)) {
     UIManager::printSuccess("Task status toggled successfully!");
+    Task* next = manager.getTask(nextOccurrenceId);
+    if (next) {
+      UIManager::printInfo(
+        "Next occurrence is task " + std::to_string(next->getId()) +
+        ", due " + next->getDueDate() + ".");
+    } else if (nextOccurrenceFailed(manager, taskId)) {
+      UIManager::printError(
+        "No task ids left for the next occurrence; the task keeps its rule.");
+    }
   } else {
     UIManager::printError("Task not found!");
   }
@@ -130,6 +279,10 @@ void searchTasksFlow(TaskManager& manager) {
 
   std::vector<Task*> tasks = manager.searchTasks(keyword);
   UIManager::printTaskList(tasks);
+  if (tasks.size() == SearchIndex::DEFAULT_LIMIT) {
+    UIManager::printInfo(
+      "Showing the " + std::to_string(tasks.size()) + " best matches.");
+  }
 }
 
 void clearAllTasksFlow(TaskManager& manager, FileHandler& fileHandler) {
@@ -147,18 +300,441 @@ void clearAllTasksFlow(TaskManager& manager, FileHandler& fileHandler) {
   }
 }
 
-int main() {
+void editTaskFlow(TaskManager& manager) {
+  std::string idStr;
+
+  std::cout << "Enter task number to edit: ";
+  std::getline(std::cin, idStr);
+
+  if (!Utils::isValidInteger(idStr)) {
+    UIManager::printError("Invalid task number!");
+    return;
+  }
+
+  Task* task = manager.getTask(Utils::stringToInt(idStr));
+  if (!task) {
+    UIManager::printError("Task not found!");
+    return;
+  }
+
+  std::string title, description, category, dueDate, priorityStr, repeat;
+  UIManager::printInfo("Leave a field empty to keep its current value.");
+
+  std::cout << "Title [" << UIManager::printable(task->getTitle()) << "]: ";
+  std::getline(std::cin, title);
+  title = Utils::trim(title);
+  if (title.empty())
+    title = task->getTitle();
+
+  std::cout << "Description ["
+            << UIManager::printable(task->getDescription()) << "]: ";
+  std::getline(std::cin, description);
+  description = Utils::trim(description);
+  if (description.empty())
+    description = task->getDescription();
+
+  std::cout << "Category [" << UIManager::printable(task->getCategory())
+            << "]: ";
+  std::getline(std::cin, category);
+  category = Utils::trim(category);
+  if (category.empty())
+    category = task->getCategory();
+
+  std::cout << "Due date [" << task->getDueDate() << "]: ";
+  std::getline(std::cin, dueDate);
+  dueDate = Utils::trim(dueDate);
+  if (dueDate.empty()) {
+    dueDate = task->getDueDate();
+  } else if (!Utils::isValidDate(dueDate)) {
+    UIManager::printError("Invalid date format! Keeping the old date.");
+    dueDate = task->getDueDate();
+  }
+
+  std::cout << "Priority [" << task->priorityToString() << "]: ";
+  std::getline(std::cin, priorityStr);
+  priorityStr = Utils::trim(priorityStr);
+  Priority priority = priorityStr.empty()
+                        ? task->getPriority()
+                        : Utils::stringToPriority(priorityStr);
+
+  std::cout << "Repeat [" << task->getRecurrence().toString()
+            << "] (\"none\" to stop): ";
+  std::getline(std::cin, repeat);
+  repeat = Utils::trim(repeat);
+  Recurrence recurrence = task->getRecurrence();
+  std::string error;
+  if (!repeat.empty() && !Recurrence::parse(repeat, recurrence, error)) {
+    UIManager::printError(error + ". Keeping the old rule.");
+    recurrence = task->getRecurrence();
+  }
+
+  manager.editTask(
+    task->getId(), title, description, category, dueDate, priority);
+  manager.setTaskRecurrence(task->getId(), recurrence);
+  UIManager::printSuccess("Task updated successfully!");
+}
+
+void queryTasksFlow(TaskManager& manager) {
+  std::string expression;
+
+  std::cout << "Enter query (e.g. category:work priority>=high not done "
+               "sort:due limit:10):\n> ";
+  std::getline(std::cin, expression);
+  expression = Utils::trim(expression);
+
+  Query query;
+  std::string error;
+  if (!Query::parse(expression, query, error)) {
+    UIManager::printError(error);
+    return;
+  }
+
+  UIManager::clearScreen();
+  UIManager::printHeader("QUERY: " + expression);
+
+  // Numbered by id, which is what toggle, delete and edit take.
+  size_t found = 0;
+  manager.runQuery(query, [&found](Task* task) {
+    UIManager::printTask(task, task->getId());
+    ++found;
+    return true;
+  });
+  if (found == 0) {
+    UIManager::printInfo("No tasks found.");
+  }
+}
+
+bool bulkActionNeedsValue(const std::string& action) {
+  return action == "category" || action == "priority";
+}
+
+// Applies one bulk action; returns false with `error` set if the action is
+// unknown.
+bool applyBulkAction(
+  TaskManager& manager,
+  const std::string& action,
+  const std::string& value,
+  const TaskSelector& selection,
+  size_t& changed,
+  std::string& error) {
+  if (action == "complete") {
+    changed = manager.setTasksCompleted(selection, true);
+  } else if (action == "reopen") {
+    changed = manager.setTasksCompleted(selection, false);
+  } else if (action == "delete") {
+    changed = manager.deleteTasks(selection);
+  } else if (action == "category") {
+    if (value.empty()) {
+      error = "Category cannot be empty!";
+      return false;
+    }
+    changed = manager.recategorizeTasks(selection, value);
+  } else if (action == "priority") {
+    changed = manager.reprioritizeTasks(
+      selection, Utils::stringToPriority(value));
+  } else {
+    error = "Unknown action: " + action;
+    return false;
+  }
+  return true;
+}
+
+void bulkOperationsFlow(TaskManager& manager) {
+  std::string action, value, spec;
+
+  std::cout << "Action (complete/reopen/delete/category/priority): ";
+  std::getline(std::cin, action);
+  action = Utils::toLowerCase(Utils::trim(action));
+
+  if (bulkActionNeedsValue(action)) {
+    std::cout << "New " << action << ": ";
+    std::getline(std::cin, value);
+    value = Utils::trim(value);
+  }
+
+  std::cout << "Tasks (e.g. 1,4,7-9 or a query such as 'category:old done'): ";
+  std::getline(std::cin, spec);
+
+  TaskSelector selection;
+  std::string error;
+  if (!TaskSelector::parse(spec, selection, error)) {
+    UIManager::printError(error);
+    return;
+  }
+
+  size_t changed = 0;
+  if (!applyBulkAction(manager, action, value, selection, changed, error)) {
+    UIManager::printError(error);
+    return;
+  }
+  UIManager::printSuccess(std::to_string(changed) + " task(s) updated.");
+}
+
+void statisticsFlow(TaskManager& manager) {
+  UIManager::clearScreen();
+  UIManager::printHeader("TASK STATISTICS");
+  UIManager::printStatistics(manager.getStatistics());
+}
+
+void performanceStatsFlow() {
+  UIManager::clearScreen();
+  UIManager::printHeader("PERFORMANCE STATS");
+  Profiler::printReport(std::cout);
+}
+
+std::string rejectedMessage(const FileHandler& fileHandler) {
+  return "Skipped " + std::to_string(fileHandler.getRejectedCount()) +
+         " malformed record(s); they were copied to " +
+         fileHandler.getRejectedFilename();
+}
+
+int runCommand(
+  const std::vector<std::string>& args,
+  TaskManager& manager,
+  FileHandler& fileHandler) {
+  const std::string& command = args[0];
+
+  if (command == "export" || command == "import") {
+    ExchangeFormat format;
+    if (args.size() < 2 || !DataExchange::formatFromPath(args[1], format)) {
+      UIManager::printError("Expected a .jsonl or .csv file path.");
+      return 1;
+    }
+
+    if (command == "export") {
+      ExchangeResult result =
+        DataExchange::exportTasks(manager, args[1], format);
+      if (!result.success) {
+        UIManager::printError("Could not write " + args[1]);
+        return 1;
+      }
+      UIManager::printSuccess(
+        "Exported " + std::to_string(result.processed) + " tasks.");
+      return 0;
+    }
+
+    ExchangeResult result = DataExchange::importTasks(manager, args[1], format);
+    if (!result.success) {
+      UIManager::printError("Could not read " + args[1]);
+      return 1;
+    }
+    if (!fileHandler.saveTasks(manager)) {
+      UIManager::printError("Could not save imported tasks!");
+      return 1;
+    }
+    UIManager::printSuccess(
+      "Imported " + std::to_string(result.processed) + " tasks.");
+    if (result.rejected > 0) {
+      UIManager::printError(
+        "Skipped " + std::to_string(result.rejected) + " invalid records.");
+    }
+    return 0;
+  }
+
+  if (command == "query") {
+    bool explain = false;
+    std::string expression;
+    for (size_t i = 1; i < args.size(); ++i) {
+      if (args[i] == "--explain") {
+        explain = true;
+      } else {
+        expression += (expression.empty() ? "" : " ") + args[i];
+      }
+    }
+
+    Query query;
+    std::string error;
+    if (!Query::parse(expression, query, error)) {
+      UIManager::printError(error);
+      return 1;
+    }
+    if (explain) {
+      UIManager::printInfo("Plan: " + manager.planQuery(query).describe());
+    }
+
+    size_t found = 0;
+    manager.runQuery(query, [&found](Task* task) {
+      UIManager::printTask(task, task->getId());
+      ++found;
+      return true;
+    });
+    if (found == 0) {
+      UIManager::printInfo("No tasks found.");
+    }
+    return 0;
+  }
+
+  if (command == "search") {
+    size_t limit = SearchIndex::DEFAULT_LIMIT;
+    std::string keyword;
+    for (size_t i = 1; i < args.size(); ++i) {
+      if (args[i] == "--limit" && i + 1 < args.size() &&
+          Utils::isValidInteger(args[i + 1]) &&
+          Utils::stringToInt(args[i + 1]) > 0) {
+        limit = static_cast<size_t>(Utils::stringToInt(args[++i]));
+      } else {
+        keyword += (keyword.empty() ? "" : " ") + args[i];
+      }
+    }
+
+    std::vector<Task*> tasks = manager.searchTasks(keyword, limit);
+    for (Task* task : tasks) {
+      UIManager::printTask(task, task->getId());
+    }
+    if (tasks.empty()) {
+      UIManager::printInfo("No tasks found.");
+    }
+    return 0;
+  }
+
+  if (command == "bulk") {
+    size_t specStart = 2;
+    std::string action = args.size() > 1 ? Utils::toLowerCase(args[1]) : "";
+    std::string value;
+    if (bulkActionNeedsValue(action)) {
+      value = args.size() > 2 ? args[2] : "";
+      specStart = 3;
+    }
+
+    std::string spec;
+    for (size_t i = specStart; i < args.size(); ++i) {
+      spec += (spec.empty() ? "" : " ") + args[i];
+    }
+
+    TaskSelector selection;
+    std::string error;
+    size_t changed = 0;
+    if (
+      !TaskSelector::parse(spec, selection, error) ||
+      !applyBulkAction(manager, action, value, selection, changed, error)) {
+      UIManager::printError(error);
+      return 1;
+    }
+    if (changed > 0 && !fileHandler.saveTasks(manager)) {
+      UIManager::printError("Could not save tasks!");
+      return 1;
+    }
+    UIManager::printSuccess(std::to_string(changed) + " task(s) updated.");
+    return 0;
+  }
+
+  if (command == "daemon") {
+    int interval = 60;
+    int ahead = 0;
+    bool once = false;
+    for (size_t i = 1; i < args.size(); ++i) {
+      bool hasValue = i + 1 < args.size() && Utils::isValidInteger(args[i + 1]);
+      if (args[i] == "--once") {
+        once = true;
+      } else if (args[i] == "--interval" && hasValue) {
+        interval = std::max(1, Utils::stringToInt(args[++i]));
+      } else if (args[i] == "--ahead" && hasValue) {
+        ahead = std::max(0, Utils::stringToInt(args[++i]));
+      } else {
+        UIManager::printError("Unknown daemon option: " + args[i]);
+        return 1;
+      }
+    }
+
+    // Prints one line per task as it comes due (or `ahead` days before),
+    // picking up changes other instances save in the meantime.
+    while (true) {
+      fileHandler.refresh(manager);
+      long today;
+      std::string horizon = Utils::today();
+      if (Utils::dateToDays(horizon, today)) {
+        horizon = Utils::daysToDate(today + ahead);
+      }
+      for (Task* task : manager.takeDueReminders(horizon)) {
+        std::cout << Utils::today() << " due " << task->getDueDate() << " #"
+                  << task->getId() << " "
+                  << UIManager::printable(task->getTitle()) << "\n";
+      }
+      std::cout.flush();
+      if (once)
+        return 0;
+      std::this_thread::sleep_for(std::chrono::seconds(interval));
+    }
+  }
+
+  if (command == "summary") {
+    if (args.size() > 1 && args[1] == "--verify") {
+      if (manager.getStatistics() != manager.recomputeStatistics()) {
+        UIManager::printError("Incremental statistics are out of date!");
+        return 1;
+      }
+      UIManager::printSuccess("Statistics match a full recompute.");
+      return 0;
+    }
+    UIManager::printStatistics(manager.getStatistics());
+    return 0;
+  }
+
+  if (command == "stats") {
+    bool json = args.size() > 1 && args[1] == "--json";
+    if (json) {
+      Profiler::dumpJson(std::cout);
+    } else {
+      // Nothing is shared between runs, so this covers only the load above.
+      if (Profiler::isEnabled()) {
+        UIManager::printInfo(
+          "Only this process is measured: loading the task file. Use menu "
+          "option 8 to see a whole session.");
+      }
+      Profiler::printReport(std::cout);
+    }
+    return 0;
+  }
+
+  UIManager::printError("Unknown command: " + command);
+  std::cout << "Usage: todo-app [stats [--json] | summary [--verify] |\n"
+               "                 query <expression> [--explain] |\n"
+               "                 search <words> [--limit N] |\n"
+               "                 daemon [--interval SECONDS] [--ahead DAYS] "
+               "[--once] |\n"
+               "                 bulk <complete|reopen|delete> <tasks> |\n"
+               "                 bulk <category|priority> <value> <tasks> |\n"
+               "                 export <file.jsonl|file.csv> |\n"
+               "                 import <file.jsonl|file.csv>]\n";
+  return 1;
+}
+
+int main(int argc, char* argv[]) {
   TaskManager manager;
   FileHandler fileHandler;
 
   fileHandler.loadTasks(manager);
+  size_t reportedRejects = 0;
+
+  if (argc > 1) {
+    if (fileHandler.getRejectedCount() > 0) {
+      UIManager::printError(rejectedMessage(fileHandler));
+    }
+    return runCommand(
+      std::vector<std::string>(argv + 1, argv + argc), manager, fileHandler);
+  }
 
   std::string choice;
   bool running = true;
 
   while (running) {
+    bool reloaded = fileHandler.refresh(manager);
+    std::string today = Utils::today();
+    std::vector<Task*> reminders = manager.takeDueReminders(today);
     UIManager::clearScreen();
     UIManager::printHeader("TODO APPLICATION");
+    if (reloaded) {
+      UIManager::printInfo("Reloaded changes saved by another instance.");
+    }
+    if (fileHandler.getRejectedCount() != reportedRejects) {
+      reportedRejects = fileHandler.getRejectedCount();
+      if (reportedRejects > 0) {
+        UIManager::printError(rejectedMessage(fileHandler));
+      }
+    }
+    if (!reminders.empty()) {
+      UIManager::printReminders(reminders, today);
+    }
     UIManager::printMenu();
 
     std::cout << "Enter your choice: ";
@@ -179,12 +755,14 @@ int main() {
         UIManager::waitForEnter();
         break;
       case 2:
-        viewAllTasksFlow(manager);
-        UIManager::waitForEnter();
+        if (viewAllTasksFlow(manager)) {
+          fileHandler.saveTasks(manager);
+        }
         break;
       case 3:
-        viewByCategoryFlow(manager);
-        UIManager::waitForEnter();
+        if (viewByCategoryFlow(manager)) {
+          fileHandler.saveTasks(manager);
+        }
         break;
       case 4:
         toggleTaskFlow(manager);
@@ -204,6 +782,28 @@ int main() {
         clearAllTasksFlow(manager, fileHandler);
         UIManager::waitForEnter();
         break;
+      case 8:
+        performanceStatsFlow();
+        UIManager::waitForEnter();
+        break;
+      case 9:
+        statisticsFlow(manager);
+        UIManager::waitForEnter();
+        break;
+      case 10:
+        editTaskFlow(manager);
+        fileHandler.saveTasks(manager);
+        UIManager::waitForEnter();
+        break;
+      case 11:
+        queryTasksFlow(manager);
+        UIManager::waitForEnter();
+        break;
+      case 12:
+        bulkOperationsFlow(manager);
+        fileHandler.saveTasks(manager);
+        UIManager::waitForEnter();
+        break;
       case 0:
         fileHandler.saveTasks(manager);
         UIManager::printSuccess("Tasks saved. Goodbye!");
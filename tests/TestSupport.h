@@ -0,0 +1,50 @@
+#ifndef TEST_SUPPORT_H
+#define TEST_SUPPORT_H
+
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+
+// Minimal checking for the test executables: a failed CHECK is reported and
+// counted, and TEST_RESULT() turns the count into the exit status CTest
+// reads.
+inline int& testFailures() {
+  static int failures = 0;
+  return failures;
+}
+
+#define CHECK(condition)                                          \
+  do {                                                            \
+    if (!(condition)) {                                           \
+      std::cerr << __FILE__ << ":" << __LINE__                    \
+                << ": CHECK failed: " #condition << std::endl;    \
+      ++testFailures();                                           \
+    }                                                             \
+  } while (0)
+
+#define TEST_RESULT()                                                  \
+  (testFailures() == 0 ? (std::cout << "All checks passed\n", 0)       \
+                       : (std::cerr << testFailures() << " failed\n", 1))
+
+// Randomized tests print their seed and accept one in TODO_TEST_SEED, so a
+// failure can be replayed.
+inline std::mt19937 seededRandom() {
+  const char* env = std::getenv("TODO_TEST_SEED");
+  unsigned seed = env ? static_cast<unsigned>(std::strtoul(env, nullptr, 10))
+                      : std::random_device()();
+  std::cout << "seed " << seed << std::endl;
+  return std::mt19937(seed);
+}
+
+inline std::string randomWord(std::mt19937& random, size_t maxLength) {
+  static const char letters[] = "abcdefghijklmnopqrstuvwxyz";
+  size_t length = 1 + random() % maxLength;
+  std::string word;
+  for (size_t i = 0; i < length; ++i) {
+    word += letters[random() % 26];
+  }
+  return word;
+}
+
+#endif
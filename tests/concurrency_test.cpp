@@ -0,0 +1,252 @@
+// Several processes edit and add tasks in one data file at the same time,
+// and no save may overwrite another instance's update; refresh() picks up
+// other instances' saves. Everything is written to a fresh temporary
+// directory, removed at the end.
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <filesystem>
+#include <functional>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "../include/FileHandler.h"
+#include "../include/TaskSelector.h"
+#include "TestSupport.h"
+
+static std::string dataFile;
+static const int WRITERS = 6;
+static const int TASKS = 60;
+static const int ROUNDS = 25;
+
+static std::string editTitle(int writer, int round) {
+  return "writer " + std::to_string(writer) + " round " +
+         std::to_string(round);
+}
+
+static std::string addedTitle(int writer, int round) {
+  return "added by " + std::to_string(writer) + " in " +
+         std::to_string(round);
+}
+
+static void editOwnedTasks(TaskManager& manager, int writer, int round) {
+  for (int id = 1; id <= TASKS; ++id) {
+    Task* task = manager.getTask(id);
+    if (id % WRITERS != writer || !task)
+      continue;
+    manager.editTask(
+      id,
+      editTitle(writer, round),
+      task->getDescription(),
+      task->getCategory(),
+      task->getDueDate(),
+      task->getPriority());
+  }
+  manager.addTask(addedTitle(writer, round));
+}
+
+// Returns the process exit status: 0 if every save succeeded.
+static int runWriter(int writer) {
+  if (writer == 0) {
+    TaskManager manager;
+    FileHandler fileHandler(dataFile);
+    fileHandler.loadTasks(manager);
+    for (int round = 0; round < ROUNDS; ++round) {
+      editOwnedTasks(manager, writer, round);
+      if (!fileHandler.saveTasks(manager))
+        return 1;
+    }
+    return 0;
+  }
+
+  for (int round = 0; round < ROUNDS; ++round) {
+    TaskManager manager;
+    FileHandler fileHandler(dataFile);
+    fileHandler.loadTasks(manager);
+    editOwnedTasks(manager, writer, round);
+    if (!fileHandler.saveTasks(manager))
+      return 1;
+  }
+  return 0;
+}
+
+static void runInChild(const std::function<int()>& body) {
+  pid_t pid = fork();
+  if (pid == 0) {
+    _exit(body());
+  }
+  int status = 0;
+  CHECK(pid > 0 && waitpid(pid, &status, 0) == pid);
+  CHECK(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+}
+
+// Two quick saves by other processes can leave the file with the inode
+// (recycled by the renames), size and mtime second it had after this
+// instance's last save, so the stat signature alone cannot tell that it
+// changed.
+static void testSaveAfterSameSecondSaves() {
+  std::remove(dataFile.c_str());
+  TaskManager manager;
+  FileHandler fileHandler(dataFile);
+  for (int i = 0; i < 3; ++i) {
+    manager.addTask("task");
+  }
+  CHECK(fileHandler.saveTasks(manager));
+
+  for (int round = 0; round < 20; ++round) {
+    Priority priority = round % 2 ? Priority::LOW : Priority::HIGH;
+    for (int id = 2; id <= 3; ++id) {
+      runInChild([id, priority]() {
+        TaskManager other;
+        FileHandler otherHandler(dataFile);
+        otherHandler.loadTasks(other);
+        other.reprioritizeTasks(TaskSelector::ids({id}), priority);
+        return otherHandler.saveTasks(other) ? 0 : 1;
+      });
+    }
+
+    manager.toggleTaskCompletion(1);
+    CHECK(fileHandler.saveTasks(manager));
+
+    TaskManager saved;
+    FileHandler savedHandler(dataFile);
+    savedHandler.loadTasks(saved);
+    for (int id = 2; id <= 3; ++id) {
+      Task* task = saved.getTask(id);
+      CHECK(task && task->getPriority() == priority);
+    }
+  }
+}
+
+// Each writer owns a disjoint set of tasks; afterwards every owned task must
+// carry its owner's last edit and every added task must be present once.
+// One writer stays loaded for the whole run and saves many times a second;
+// the others load, edit and save afresh each round like command-line runs.
+static void testConcurrentWriters() {
+  std::remove(dataFile.c_str());
+  {
+    TaskManager manager;
+    FileHandler fileHandler(dataFile);
+    for (int id = 1; id <= TASKS; ++id) {
+      manager.addTask("task " + std::to_string(id));
+    }
+    CHECK(fileHandler.saveTasks(manager));
+  }
+
+  std::vector<pid_t> children;
+  for (int writer = 0; writer < WRITERS; ++writer) {
+    pid_t pid = fork();
+    if (pid == 0) {
+      _exit(runWriter(writer));
+    }
+    CHECK(pid > 0);
+    children.push_back(pid);
+  }
+  for (pid_t pid : children) {
+    int status = 0;
+    CHECK(waitpid(pid, &status, 0) == pid);
+    CHECK(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+  }
+
+  TaskManager manager;
+  FileHandler fileHandler(dataFile);
+  CHECK(fileHandler.loadTasks(manager));
+  CHECK(fileHandler.getRejectedCount() == 0);
+
+  for (int id = 1; id <= TASKS; ++id) {
+    Task* task = manager.getTask(id);
+    CHECK(task != nullptr);
+    if (task && task->getTitle() != editTitle(id % WRITERS, ROUNDS - 1)) {
+      std::cerr << "task " << id << " lost its last edit: "
+                << task->getTitle() << std::endl;
+      CHECK(false);
+    }
+  }
+
+  std::multiset<std::string> added;
+  std::set<int> ids;
+  for (Task* task : manager.getAllTasks()) {
+    CHECK(ids.insert(task->getId()).second);
+    if (task->getId() > TASKS) {
+      added.insert(task->getTitle());
+    }
+  }
+  CHECK(added.size() == static_cast<size_t>(WRITERS * ROUNDS));
+  for (int writer = 0; writer < WRITERS; ++writer) {
+    for (int round = 0; round < ROUNDS; ++round) {
+      CHECK(added.count(addedTitle(writer, round)) == 1);
+    }
+  }
+  CHECK(manager.getStatistics() == manager.recomputeStatistics());
+}
+
+// Another instance edits, deletes and adds tasks; refresh() must apply
+// exactly those records, keep this instance's unsaved edit, and leave
+// untouched tasks as they are rather than reload them.
+static void testRefresh() {
+  std::remove(dataFile.c_str());
+  TaskManager manager;
+  FileHandler fileHandler(dataFile);
+  for (int id = 1; id <= 4; ++id) {
+    manager.addTask("task " + std::to_string(id));
+  }
+  CHECK(fileHandler.saveTasks(manager));
+  CHECK(!fileHandler.refresh(manager));
+
+  manager.editTask(1, "local edit", "", "General", "", Priority::MEDIUM);
+  Task* untouched = manager.getTask(4);
+
+  runInChild([]() {
+    TaskManager other;
+    FileHandler otherHandler(dataFile);
+    otherHandler.loadTasks(other);
+    other.editTask(2, "remote edit", "", "Work", "", Priority::HIGH);
+    other.deleteTask(3);
+    other.addTask("remote add");
+    return otherHandler.saveTasks(other) ? 0 : 1;
+  });
+
+  CHECK(fileHandler.refresh(manager));
+  CHECK(!fileHandler.refresh(manager));
+  Task* task = manager.getTask(1);
+  CHECK(task && task->getTitle() == "local edit");
+  task = manager.getTask(2);
+  CHECK(task && task->getTitle() == "remote edit");
+  CHECK(task && task->getCategory() == "Work");
+  CHECK(manager.getTask(3) == nullptr);
+  CHECK(manager.getTask(4) == untouched);
+  task = manager.getTask(5);
+  CHECK(task && task->getTitle() == "remote add");
+  CHECK(manager.getAllTasks().size() == 4);
+  CHECK(manager.getStatistics() == manager.recomputeStatistics());
+
+  // The local edit is still unsaved and reaches the file on the next save.
+  CHECK(fileHandler.saveTasks(manager));
+  TaskManager saved;
+  FileHandler savedHandler(dataFile);
+  savedHandler.loadTasks(saved);
+  task = saved.getTask(1);
+  CHECK(task && task->getTitle() == "local edit");
+  CHECK(saved.getAllTasks().size() == 4);
+}
+
+int main() {
+  std::string pattern =
+    (std::filesystem::temp_directory_path() / "todo-concurrency-XXXXXX")
+      .string();
+  if (!mkdtemp(&pattern[0])) {
+    std::cerr << "cannot create a temporary directory" << std::endl;
+    return 1;
+  }
+  dataFile = pattern + "/tasks.dat";
+
+  testRefresh();
+  testSaveAfterSameSecondSaves();
+  testConcurrentWriters();
+
+  std::filesystem::remove_all(pattern);
+  return TEST_RESULT();
+}
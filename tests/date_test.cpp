@@ -0,0 +1,61 @@
+// Utils::formatDate caches the day it last formatted; check it against an
+// uncached localtime() around DST changes, visiting timestamps out of order
+// so every cache state is exercised.
+
+#include <cstdlib>
+#include <ctime>
+#include <string>
+
+#include "../include/Utils.h"
+#include "TestSupport.h"
+
+static void setTimeZone(const char* zone) {
+#ifdef _WIN32
+  _putenv_s("TZ", zone);
+  _tzset();
+#else
+  setenv("TZ", zone, 1);
+  tzset();
+#endif
+}
+
+static std::string uncachedDate(time_t timestamp) {
+  char buffer[16];
+  strftime(buffer, sizeof(buffer), "%Y-%m-%d", localtime(&timestamp));
+  return buffer;
+}
+
+int main() {
+  std::mt19937 random = seededRandom();
+
+  // 2026-03-08 10:00 EDT warms the cache; 2026-03-07 23:30 EST is the day
+  // before.
+  setTimeZone("America/New_York");
+  CHECK(Utils::formatDate(1772978400) == "2026-03-08");
+  CHECK(Utils::formatDate(1772944200) == "2026-03-07");
+
+  // Zones with 1-hour, 30-minute and southern-hemisphere DST changes.
+  const char* zones[] = {
+    "America/New_York", "Europe/London", "Australia/Lord_Howe", "UTC"};
+  for (const char* zone : zones) {
+    setTimeZone(zone);
+    // Around every day of 2026, in random order.
+    for (int i = 0; i < 100000; ++i) {
+      time_t timestamp = 1767225600 + static_cast<time_t>(random() % 31622400);
+      if (Utils::formatDate(timestamp) != uncachedDate(timestamp)) {
+        std::cerr << zone << " " << timestamp << std::endl;
+        CHECK(false);
+        break;
+      }
+    }
+  }
+
+  // Day numbers round-trip through dates.
+  for (long days = -800000; days < 3000000; days += 997) {
+    long back = 0;
+    std::string date = Utils::daysToDate(days);
+    CHECK(date.empty() || (Utils::dateToDays(date, back) && back == days));
+  }
+
+  return TEST_RESULT();
+}
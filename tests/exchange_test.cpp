@@ -0,0 +1,116 @@
+// Import/export through DataExchange: CSV quoting, records that run away,
+// and export/import round trips in both formats.
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "../include/DataExchange.h"
+#include "TestSupport.h"
+
+static void writeFile(const std::string& path, const std::string& content) {
+  std::ofstream file(path, std::ios::binary | std::ios::trunc);
+  file << content;
+}
+
+static bool sameTask(const Task& a, const Task& b) {
+  return a.getTitle() == b.getTitle() &&
+         a.getDescription() == b.getDescription() &&
+         a.getCategory() == b.getCategory() &&
+         a.getDueDate() == b.getDueDate() &&
+         a.getPriority() == b.getPriority() &&
+         a.isCompleted() == b.isCompleted() &&
+         a.getCreatedAt() == b.getCreatedAt() &&
+         a.getCompletedAt() == b.getCompletedAt() &&
+         a.getRecurrence() == b.getRecurrence();
+}
+
+static void testStrayQuote() {
+  // A quote inside an unquoted field is literal and must not join rows.
+  writeFile(
+    "exchange_quote.csv",
+    "title,description,category\n"
+    "1,27\" monitor,desk\n"
+    "second,b,c\n"
+    "third,\"quoted \"\"x\"\", with comma\nand newline\",c\n");
+  TaskManager manager;
+  ExchangeResult result = DataExchange::importTasks(
+    manager, "exchange_quote.csv", ExchangeFormat::CSV);
+  CHECK(result.success);
+  CHECK(result.processed == 3);
+  CHECK(result.rejected == 0);
+  std::vector<Task*> tasks = manager.getAllTasks();
+  CHECK(tasks.size() == 3);
+  if (tasks.size() == 3) {
+    CHECK(tasks[0]->getDescription() == "27\" monitor");
+    CHECK(tasks[1]->getTitle() == "second");
+    CHECK(
+      tasks[2]->getDescription() == "quoted \"x\", with comma\nand newline");
+  }
+}
+
+static void testRunawayRecord() {
+  // An unterminated quote is cut off at MAX_RECORD_SIZE and rejected, and
+  // reading carries on after it.
+  std::string content = "title\n\"unterminated\n";
+  std::string line(100, 'x');
+  size_t lines = 2 * DataExchange::MAX_RECORD_SIZE / line.size();
+  for (size_t i = 0; i < lines; ++i) {
+    content += line + "\n";
+  }
+  content += "last\n";
+  writeFile("exchange_runaway.csv", content);
+
+  TaskManager manager;
+  ExchangeResult result = DataExchange::importTasks(
+    manager, "exchange_runaway.csv", ExchangeFormat::CSV);
+  CHECK(result.rejected == 1);
+  CHECK(result.processed > 0);
+  std::vector<Task*> tasks = manager.getAllTasks();
+  CHECK(!tasks.empty() && tasks.back()->getTitle() == "last");
+}
+
+static void testRoundTrip(std::mt19937& random, ExchangeFormat format) {
+  static const std::string awkward[] = {
+    "plain", "comma, inside", "\"quoted\"", "new\nline", "tab\tand \\",
+    "é ✓"};
+  TaskManager source;
+  for (int i = 0; i < 500; ++i) {
+    Recurrence rule;
+    std::string error;
+    Recurrence::parse(i % 3 ? "" : "weekly:mon,thu", rule, error);
+    source.addTask(
+      awkward[random() % 6] + randomWord(random, 6),
+      awkward[random() % 6],
+      awkward[random() % 6],
+      i % 2 ? "2026-05-17" : "",
+      static_cast<Priority>(random() % 3),
+      rule);
+    if (random() % 2) {
+      source.toggleTaskCompletion(i + 1);
+    }
+  }
+
+  std::string path = format == ExchangeFormat::CSV ? "exchange_round.csv"
+                                                   : "exchange_round.jsonl";
+  CHECK(DataExchange::exportTasks(source, path, format).success);
+  TaskManager target;
+  ExchangeResult result = DataExchange::importTasks(target, path, format);
+  CHECK(result.rejected == 0);
+
+  std::vector<Task*> expected = source.getAllTasks();
+  std::vector<Task*> actual = target.getAllTasks();
+  CHECK(expected.size() == actual.size());
+  for (size_t i = 0; i < expected.size() && i < actual.size(); ++i) {
+    CHECK(sameTask(*expected[i], *actual[i]));
+  }
+}
+
+int main() {
+  std::mt19937 random = seededRandom();
+  testStrayQuote();
+  testRunawayRecord();
+  testRoundTrip(random, ExchangeFormat::CSV);
+  testRoundTrip(random, ExchangeFormat::JSONL);
+  return TEST_RESULT();
+}
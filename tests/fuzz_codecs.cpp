@@ -0,0 +1,140 @@
+// libFuzzer entry point over every parser that reads untrusted bytes: the
+// data file record codec, JSON records, CSV and JSON Lines import, and
+// whole data file loads. The first byte picks the codec and the rest is its
+// input. Besides crashes and sanitizer reports, each codec checks that what
+// it accepted survives being written back out and read again.
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "../include/DataExchange.h"
+#include "../include/FileHandler.h"
+
+#define FUZZ_CHECK(condition)                                           \
+  do {                                                                  \
+    if (!(condition)) {                                                 \
+      std::cerr << __FILE__ << ":" << __LINE__                          \
+                << ": FUZZ_CHECK failed: " #condition << std::endl;     \
+      std::abort();                                                     \
+    }                                                                   \
+  } while (0)
+
+static const char* const INPUT_FILE = "todo-fuzz.input";
+static const char* const DATA_FILE = "todo-fuzz.dat";
+
+static void writeFile(const std::string& path, const std::string& content) {
+  std::ofstream file(path, std::ios::binary | std::ios::trunc);
+  file << content;
+}
+
+static std::vector<std::string> serializeAll(TaskManager& manager) {
+  std::vector<std::string> records;
+  for (Task* task : manager.getAllTasks()) {
+    records.push_back(task->serialize());
+  }
+  std::sort(records.begin(), records.end());
+  return records;
+}
+
+static void fuzzDeserialize(const std::string& input) {
+  Task task(1, "");
+  try {
+    task = Task::deserialize(input);
+  } catch (const std::exception&) {
+    return;
+  }
+  FUZZ_CHECK(task.getId() >= 1 && task.getId() <= Task::MAX_ID);
+  std::string record = task.serialize();
+  FUZZ_CHECK(Task::deserialize(record).serialize() == record);
+}
+
+static void fuzzJsonRecord(const std::string& input) {
+  Task task(1, "");
+  if (!DataExchange::parseJsonRecord(input, task))
+    return;
+  std::string record;
+  DataExchange::appendJsonRecord(record, task);
+  record.pop_back();  // the newline ending the record
+
+  Task again(1, "");
+  FUZZ_CHECK(DataExchange::parseJsonRecord(record, again));
+  std::string second;
+  DataExchange::appendJsonRecord(second, again);
+  second.pop_back();
+  FUZZ_CHECK(second == record);
+}
+
+// Whatever is imported must export and import again as the same number of
+// tasks, and the incremental statistics must match a recompute.
+static void fuzzImport(const std::string& input, ExchangeFormat format) {
+  writeFile(INPUT_FILE, input);
+  TaskManager manager;
+  ExchangeResult result =
+    DataExchange::importTasks(manager, INPUT_FILE, format);
+  FUZZ_CHECK(result.processed == manager.getAllTasks().size());
+  FUZZ_CHECK(manager.getStatistics() == manager.recomputeStatistics());
+
+  FUZZ_CHECK(
+    DataExchange::exportTasks(manager, INPUT_FILE, ExchangeFormat::JSONL)
+      .success);
+  TaskManager reimported;
+  result =
+    DataExchange::importTasks(reimported, INPUT_FILE, ExchangeFormat::JSONL);
+  FUZZ_CHECK(result.rejected == 0);
+  FUZZ_CHECK(result.processed == manager.getAllTasks().size());
+}
+
+// A loaded file saves and loads back as the same tasks, and skipped lines
+// never take the id counter out of range.
+static void fuzzLoad(const std::string& input) {
+  writeFile(DATA_FILE, input);
+  std::remove((std::string(DATA_FILE) + ".rejected").c_str());
+
+  TaskManager manager;
+  FileHandler fileHandler(DATA_FILE);
+  fileHandler.loadTasks(manager);
+  FUZZ_CHECK(manager.getStatistics() == manager.recomputeStatistics());
+  FUZZ_CHECK(manager.getNextId() >= 1);
+  for (Task* task : manager.getAllTasks()) {
+    FUZZ_CHECK(task->getId() < manager.getNextId());
+  }
+
+  FUZZ_CHECK(fileHandler.saveTasks(manager));
+  TaskManager reloaded;
+  FileHandler reloadHandler(DATA_FILE);
+  FUZZ_CHECK(reloadHandler.loadTasks(reloaded));
+  FUZZ_CHECK(reloadHandler.getRejectedCount() == 0);
+  FUZZ_CHECK(serializeAll(reloaded) == serializeAll(manager));
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+  if (size == 0)
+    return 0;
+  std::string input(reinterpret_cast<const char*>(data) + 1, size - 1);
+  switch (data[0] % 5) {
+    case 0:
+      fuzzDeserialize(input);
+      break;
+    case 1:
+      fuzzJsonRecord(input);
+      break;
+    case 2:
+      fuzzImport(input, ExchangeFormat::CSV);
+      break;
+    case 3:
+      fuzzImport(input, ExchangeFormat::JSONL);
+      break;
+    default:
+      fuzzLoad(input);
+      break;
+  }
+  return 0;
+}
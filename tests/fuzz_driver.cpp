@@ -0,0 +1,166 @@
+// Stands in for libFuzzer's main where it is not available (GCC, MSVC), so
+// the same entry point still builds and runs everywhere:
+//
+//   todo-fuzz [-runs=N] [file-or-directory ...]
+//
+// Every named file (and every file in a named directory) is run as is,
+// then N inputs (default 10000) are made by randomly mutating them and a
+// built-in valid input for each codec. Each input is written to
+// "todo-fuzz.last" before it runs, so the one that crashed can be replayed.
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "../include/DataExchange.h"
+#include "TestSupport.h"
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size);
+
+static void runInput(const std::string& input) {
+  {
+    std::ofstream last("todo-fuzz.last", std::ios::binary | std::ios::trunc);
+    last << input;
+  }
+  LLVMFuzzerTestOneInput(
+    reinterpret_cast<const uint8_t*>(input.data()), input.size());
+}
+
+static bool readFile(const std::string& path, std::string& content) {
+  std::ifstream file(path, std::ios::binary);
+  if (!file.is_open())
+    return false;
+  content.assign(
+    std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+  return true;
+}
+
+// One well-formed input per codec, built through the writers so they follow
+// any change to the formats.
+static std::vector<std::string> builtInSeeds() {
+  Task task(2, "Pay | rent", "line one\nline \"two\"", "Home", "2026-11-01");
+  task.setPriority(Priority::HIGH);
+  Recurrence rule;
+  std::string error;
+  Recurrence::parse("monthly:1", rule, error);
+  task.setRecurrence(rule);
+  Task done(3, "Done, really", "", "Work");
+  done.restoreState(true, 1767225600, 1767312000);
+
+  std::string json, csv;
+  DataExchange::appendJsonRecord(json, task);
+  DataExchange::appendJsonRecord(json, done);
+  DataExchange::appendCsvHeader(csv);
+  DataExchange::appendCsvRecord(csv, task);
+  DataExchange::appendCsvRecord(csv, done);
+
+  return {
+    std::string(1, '\0') + task.serialize(),
+    "\1" + json.substr(0, json.find('\n')),
+    "\2" + csv,
+    "\3" + json,
+    "\4" "4|7\n" + task.serialize() + "|6\n" + done.serialize() + "|7\n"};
+}
+
+static std::string mutate(
+  std::mt19937& random,
+  const std::vector<std::string>& seeds) {
+  static const char* const tokens[] = {
+    "|", "\\", "\\|", "\"", ",", "\n", "\r\n", "{", "}", ":", "\\u0000",
+    "\\ud800", "true", "2026-02-29", "cron:* * mon-fri", "weekly/0:", "\xff",
+    "\xe4\xb8"};
+  static const char* const numbers[] = {
+    "0", "-1", "2147483646", "2147483647", "2147483648",
+    "9223372036854775807", "9223372036854775808", "-9223372036854775808"};
+  std::string input = seeds[random() % seeds.size()];
+  size_t edits = 1 + random() % 8;
+  for (size_t i = 0; i < edits; ++i) {
+    size_t at = input.empty() ? 0 : random() % (input.size() + 1);
+    switch (random() % 7) {
+      case 0:
+        if (at < input.size())
+          input[at] = static_cast<char>(random());
+        break;
+      case 1:
+        input.insert(at, 1, static_cast<char>(random()));
+        break;
+      case 2:
+        input.insert(at, tokens[random() % (sizeof tokens / sizeof *tokens)]);
+        break;
+      case 3:
+        input.erase(at, random() % 16);
+        break;
+      case 4:
+        if (at < input.size())
+          input.insert(at, input.substr(at, random() % 64));
+        break;
+      case 5: {
+        // Swap the next number for a boundary value; ids, priorities and
+        // timestamps are all numbers.
+        size_t start = input.find_first_of("0123456789", at);
+        if (start == std::string::npos)
+          break;
+        size_t end = input.find_first_not_of("0123456789", start);
+        input.replace(
+          start,
+          end == std::string::npos ? std::string::npos : end - start,
+          numbers[random() % (sizeof numbers / sizeof *numbers)]);
+        break;
+      }
+      default: {
+        // Splice in part of another seed.
+        const std::string& other = seeds[random() % seeds.size()];
+        size_t from = other.empty() ? 0 : random() % other.size();
+        input.insert(at, other.substr(from, random() % 64));
+        break;
+      }
+    }
+  }
+  return input;
+}
+
+int main(int argc, char** argv) {
+  long runs = 10000;
+  std::vector<std::string> seeds = builtInSeeds();
+
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+    if (arg.compare(0, 6, "-runs=") == 0) {
+      runs = std::strtol(arg.c_str() + 6, nullptr, 10);
+      continue;
+    }
+    if (arg[0] == '-')
+      continue;  // other libFuzzer flags
+
+    std::vector<std::string> paths;
+    if (std::filesystem::is_directory(arg)) {
+      for (const auto& entry : std::filesystem::directory_iterator(arg)) {
+        if (entry.is_regular_file())
+          paths.push_back(entry.path().string());
+      }
+    } else {
+      paths.push_back(arg);
+    }
+    for (const std::string& path : paths) {
+      std::string content;
+      if (!readFile(path, content)) {
+        std::cerr << "cannot read " << path << std::endl;
+        return 1;
+      }
+      runInput(content);
+      seeds.push_back(content);
+    }
+  }
+
+  std::mt19937 random = seededRandom();
+  for (long run = 0; run < runs; ++run) {
+    runInput(mutate(random, seeds));
+  }
+  std::cout << "Ran " << runs << " mutated inputs\n";
+  return 0;
+}
@@ -0,0 +1,121 @@
+// Round-trip properties of the task codecs over random tasks: the data file
+// record format and JSON records must give back every field, whatever bytes
+// the text fields hold.
+
+#include <string>
+
+#include "../include/DataExchange.h"
+#include "TestSupport.h"
+
+static const int TASKS = 20000;
+
+static bool sameTask(const Task& a, const Task& b) {
+  return a.getId() == b.getId() && a.getTitle() == b.getTitle() &&
+         a.getDescription() == b.getDescription() &&
+         a.getCategory() == b.getCategory() &&
+         a.getDueDate() == b.getDueDate() &&
+         a.getPriority() == b.getPriority() &&
+         a.isCompleted() == b.isCompleted() &&
+         a.getCreatedAt() == b.getCreatedAt() &&
+         a.getCompletedAt() == b.getCompletedAt() &&
+         a.getRecurrence() == b.getRecurrence();
+}
+
+// Any bytes, weighted towards the ones the encoders escape.
+static std::string randomText(std::mt19937& random, size_t maxLength) {
+  static const char special[] = "|\\\"\n\r\t,{}:";
+  std::string text;
+  size_t length = random() % (maxLength + 1);
+  for (size_t i = 0; i < length; ++i) {
+    switch (random() % 4) {
+      case 0:
+        text += special[random() % (sizeof special - 1)];
+        break;
+      case 1:
+        text += static_cast<char>(random());
+        break;
+      default:
+        text += static_cast<char>('a' + random() % 26);
+        break;
+    }
+  }
+  return text;
+}
+
+static long long randomTimestamp(std::mt19937_64& random) {
+  switch (random() % 3) {
+    case 0:
+      return 0;
+    case 1:
+      return static_cast<long long>(random());  // any 64-bit value
+    default:
+      return 1767225600 + static_cast<long long>(random() % 100000000);
+  }
+}
+
+static Task randomTask(std::mt19937& random, std::mt19937_64& random64) {
+  static const char* const rules[] = {
+    "", "daily", "daily/3", "weekly:mon,fri", "monthly:31", "cron:* * sat"};
+  std::string title = randomText(random, 40);
+  std::string category = randomText(random, 10);
+  std::string dueDate;
+  if (random() % 2) {
+    dueDate = "2026-0" + std::to_string(1 + random() % 9) + "-2" +
+              std::to_string(random() % 9);
+  }
+  Task task(
+    1 + static_cast<int>(random() % Task::MAX_ID),
+    title.empty() ? "t" : title,
+    randomText(random, 80),
+    category.empty() ? "General" : category,
+    dueDate,
+    static_cast<Priority>(random() % 3));
+  bool completed = random() % 2;
+  task.restoreState(
+    completed,
+    static_cast<time_t>(randomTimestamp(random64)),
+    completed ? static_cast<time_t>(randomTimestamp(random64)) : 0);
+  Recurrence rule;
+  std::string error;
+  Recurrence::parse(rules[random() % 6], rule, error);
+  task.setRecurrence(rule);
+  return task;
+}
+
+static void testRecordRoundTrip(const Task& task) {
+  try {
+    Task decoded = Task::deserialize(task.serialize());
+    if (!sameTask(decoded, task)) {
+      std::cerr << "record: " << task.serialize() << std::endl;
+      CHECK(false);
+    }
+  } catch (const std::exception& e) {
+    std::cerr << "record: " << task.serialize() << ": " << e.what()
+              << std::endl;
+    CHECK(false);
+  }
+}
+
+static void testJsonRoundTrip(const Task& task) {
+  std::string record;
+  DataExchange::appendJsonRecord(record, task);
+  record.pop_back();  // the newline ending the record
+  Task decoded(task.getId(), "");
+  if (
+    !DataExchange::parseJsonRecord(record, decoded) ||
+    !sameTask(decoded, task)) {
+    std::cerr << "json: " << record << std::endl;
+    CHECK(false);
+  }
+}
+
+int main() {
+  std::mt19937 random = seededRandom();
+  std::mt19937_64 random64(random());
+  for (int i = 0; i < TASKS && testFailures() < 10; ++i) {
+    Task task = randomTask(random, random64);
+    testRecordRoundTrip(task);
+    testJsonRoundTrip(task);
+  }
+  return TEST_RESULT();
+}
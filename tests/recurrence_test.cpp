@@ -0,0 +1,147 @@
+// Recurrence rules and the reminder scheduler: parsing and next dates,
+// renumbering a recurring task, reminders across clearAllTasks,
+// completing a recurring task once ids run out, and the ids a bulk
+// completion gives the next occurrences.
+
+#include <string>
+#include <vector>
+
+#include "../include/Scheduler.h"
+#include "../include/TaskManager.h"
+#include "../include/TaskSelector.h"
+#include "TestSupport.h"
+
+static Recurrence rule(const std::string& text) {
+  Recurrence parsed;
+  std::string error;
+  CHECK(Recurrence::parse(text, parsed, error));
+  return parsed;
+}
+
+static void testParse() {
+  const char* const canonical[] = {
+    "daily", "daily/3", "weekly", "weekly/2:mon,thu", "monthly",
+    "monthly:31", "cron:1,15 * *"};
+  for (const char* text : canonical) {
+    CHECK(rule(text).toString() == text);
+    CHECK(rule(rule(text).toString()) == rule(text));
+  }
+  CHECK(!rule("").isRecurring());
+  CHECK(!rule("none").isRecurring());
+
+  const char* const invalid[] = {
+    "hourly", "daily/0", "weekly:funday", "monthly:32", "cron:* *"};
+  for (const char* text : invalid) {
+    Recurrence parsed;
+    std::string error;
+    CHECK(!Recurrence::parse(text, parsed, error) && !error.empty());
+  }
+}
+
+static void testNextAfter() {
+  CHECK(rule("daily").nextAfter("2026-12-31") == "2027-01-01");
+  CHECK(rule("daily/3").nextAfter("2026-02-27") == "2026-03-02");
+  // 2026-10-19 is a Monday.
+  CHECK(rule("weekly:mon").nextAfter("2026-10-19") == "2026-10-26");
+  CHECK(rule("weekly:mon,thu").nextAfter("2026-10-19") == "2026-10-22");
+  CHECK(rule("monthly:31").nextAfter("2026-01-31") == "2026-02-28");
+  CHECK(rule("cron:* * mon-fri").nextAfter("2026-10-23") == "2026-10-26");
+  CHECK(rule("daily").nextAfter("not a date").empty());
+}
+
+// A renumbered task keeps everything but its id.
+static void testRenumberKeepsRule() {
+  TaskManager manager;
+  manager.addTask(
+    "Standup", "daily sync", "Work", "2026-10-19", Priority::HIGH,
+    rule("weekly:mon"));
+  Task before = *manager.getTask(1);
+
+  int newId = manager.renumberTask(1);
+  Task* after = manager.getTask(newId);
+  CHECK(newId != 1 && manager.getTask(1) == nullptr && after != nullptr);
+  if (after) {
+    CHECK(after->getRecurrence() == rule("weekly:mon"));
+    CHECK(after->getTitle() == before.getTitle());
+    CHECK(after->getDescription() == before.getDescription());
+    CHECK(after->getCategory() == before.getCategory());
+    CHECK(after->getDueDate() == before.getDueDate());
+    CHECK(after->getPriority() == before.getPriority());
+    CHECK(after->getCreatedAt() == before.getCreatedAt());
+  }
+}
+
+static void testReminders() {
+  Scheduler scheduler;
+  Task task(7, "Pay rent", "", "Home", "2026-11-01");
+  scheduler.schedule(task);
+  scheduler.schedule(task);  // a duplicate entry, as an edit leaves
+  auto current = [](const ScheduledTask&) { return true; };
+  CHECK(scheduler.takeDue("2026-10-31", current).empty());
+  CHECK(scheduler.takeDue("2026-11-01", current) == std::vector<int>{7});
+  scheduler.clear();
+  scheduler.schedule(task);
+  CHECK(scheduler.takeDue("2026-11-01", current).empty());
+  scheduler.reset();
+  scheduler.schedule(task);
+  CHECK(scheduler.takeDue("2026-11-01", current) == std::vector<int>{7});
+}
+
+// Ids start over after a clear, so a new task #1 due on the day the old
+// one was reminded for is still a different task to remind about.
+static void testRemindersAfterClear() {
+  TaskManager manager;
+  manager.addTask("Old", "", "", "2026-10-20");
+  CHECK(manager.takeDueReminders("2026-10-20").size() == 1);
+  CHECK(manager.takeDueReminders("2026-10-20").empty());
+
+  manager.clearAllTasks();
+  manager.addTask("New", "", "", "2026-10-20");
+  std::vector<Task*> due = manager.takeDueReminders("2026-10-20");
+  CHECK(due.size() == 1 && due[0]->getTitle() == "New");
+}
+
+// With every id taken the next occurrence cannot be added, and the rule
+// must stay with the completed task rather than be lost.
+static void testCompleteWithoutIds() {
+  TaskManager manager;
+  manager.addTask(
+    "Water plants", "", "Home", "2026-10-19", Priority::LOW, rule("daily"));
+  manager.restoreTask(Task(Task::MAX_ID, "Last id"));
+
+  int nextOccurrenceId = 0;
+  CHECK(manager.toggleTaskCompletion(1, &nextOccurrenceId));
+  CHECK(nextOccurrenceId == -1);
+  CHECK(manager.getAllTasks().size() == 2);
+  Task* task = manager.getTask(1);
+  CHECK(task && task->isCompleted());
+  CHECK(task && task->getRecurrence() == rule("daily"));
+}
+
+// Next occurrences are numbered in the order of the tasks' ids, not of
+// where the tasks happen to sit in memory.
+static void testBulkCompleteOrder() {
+  TaskManager manager;
+  for (int id : {5, 3, 4}) {
+    Task task(id, "Task " + std::to_string(id), "", "Home", "2026-10-19");
+    task.setRecurrence(rule("daily"));
+    manager.restoreTask(task);
+  }
+
+  CHECK(manager.setTasksCompleted(TaskSelector::range(1, 10), true) == 3);
+  for (int id = 6; id <= 8; ++id) {
+    Task* next = manager.getTask(id);
+    CHECK(next && next->getTitle() == "Task " + std::to_string(id - 3));
+  }
+}
+
+int main() {
+  testParse();
+  testNextAfter();
+  testRenumberKeepsRule();
+  testReminders();
+  testRemindersAfterClear();
+  testCompleteWithoutIds();
+  testBulkCompleteOrder();
+  return TEST_RESULT();
+}
@@ -0,0 +1,148 @@
+// SearchIndex: the bit-parallel edit distance against a plain dynamic
+// program, an index maintained through random edits against one built
+// afresh, very large task ids and the id limit, and basic ranking.
+
+#include <algorithm>
+#include <climits>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "../include/SearchIndex.h"
+#include "../include/TaskManager.h"
+#include "TestSupport.h"
+
+static size_t referenceDistance(const std::string& a, const std::string& b) {
+  std::vector<size_t> previous(b.size() + 1), current(b.size() + 1);
+  for (size_t j = 0; j <= b.size(); ++j) {
+    previous[j] = j;
+  }
+  for (size_t i = 1; i <= a.size(); ++i) {
+    current[0] = i;
+    for (size_t j = 1; j <= b.size(); ++j) {
+      current[j] = std::min(
+        {previous[j] + 1,
+         current[j - 1] + 1,
+         previous[j - 1] + (a[i - 1] == b[j - 1] ? 0 : 1)});
+    }
+    previous.swap(current);
+  }
+  return previous[b.size()];
+}
+
+static std::string randomText(std::mt19937& random, size_t maxLength) {
+  // A small alphabet so strings share letters and distances vary.
+  std::string text;
+  size_t length = random() % (maxLength + 1);
+  for (size_t i = 0; i < length; ++i) {
+    text += "abcde"[random() % 5];
+  }
+  return text;
+}
+
+static void testEditDistance(std::mt19937& random) {
+  for (int i = 0; i < 20000; ++i) {
+    // Mostly within the 64-byte bit-parallel limit, sometimes beyond it.
+    size_t maxLength = i % 10 == 0 ? 100 : 20;
+    std::string a = randomText(random, maxLength);
+    std::string b = randomText(random, maxLength);
+    if (SearchIndex::editDistance(a, b) != referenceDistance(a, b)) {
+      std::cerr << a << " / " << b << std::endl;
+      CHECK(false);
+      return;
+    }
+  }
+}
+
+static std::string randomSentence(std::mt19937& random) {
+  static const char* const words[] = {
+    "meeting", "report", "groceries", "dentist", "invoice", "meetings",
+    "reports", "garden", "review", "taxes", "deploy", "deployment"};
+  std::string sentence;
+  size_t count = 1 + random() % 4;
+  for (size_t i = 0; i < count; ++i) {
+    sentence += (i ? " " : "") + std::string(words[random() % 12]);
+  }
+  return sentence;
+}
+
+static void testIncrementalMatchesFresh(std::mt19937& random) {
+  std::map<int, Task> tasks;
+  SearchIndex incremental;
+  for (int step = 0; step < 5000; ++step) {
+    // Ids far apart, as renumbering and merges can leave them.
+    int id = 1 + static_cast<int>(random() % 300) * 1000003;
+    if (random() % 4 == 0) {
+      tasks.erase(id);
+      incremental.remove(id);
+    } else {
+      Task task(id, randomSentence(random), randomSentence(random));
+      tasks.erase(id);
+      tasks.emplace(id, task);
+      incremental.add(task);
+    }
+  }
+
+  SearchIndex fresh;
+  for (const auto& entry : tasks) {
+    fresh.add(entry.second);
+  }
+
+  const char* const queries[] = {
+    "meeting", "meetng", "rep", "deploy review", "grocerys", "tax", "xyz"};
+  for (const char* query : queries) {
+    std::vector<SearchHit> a = incremental.search(query, 1000);
+    std::vector<SearchHit> b = fresh.search(query, 1000);
+    CHECK(a.size() == b.size());
+    for (size_t i = 0; i < a.size() && i < b.size(); ++i) {
+      CHECK(a[i].taskId == b[i].taskId && a[i].score == b[i].score);
+    }
+  }
+}
+
+static void testLargeIds() {
+  // Per-task state is not sized by the id, so these cost two slots.
+  TaskManager manager;
+  manager.restoreTask(Task(500000000, "Quarterly report"));
+  manager.restoreTask(Task(Task::MAX_ID, "Report archive", "old reports"));
+  std::vector<Task*> hits = manager.searchTasks("report");
+  CHECK(hits.size() == 2);
+  if (hits.size() == 2) {
+    CHECK(hits[0]->getId() == 500000000);
+    CHECK(hits[1]->getId() == Task::MAX_ID);
+  }
+  manager.deleteTask(500000000);
+  CHECK(manager.searchTasks("quarterly").empty());
+
+  // Every id has been handed out; nothing may wrap past INT_MAX.
+  CHECK(manager.getNextId() == INT_MAX);
+  CHECK(!manager.addTask("One too many"));
+  CHECK(manager.renumberTask(Task::MAX_ID) == -1);
+  CHECK(!manager.restoreTask(Task(INT_MAX, "Out of range")));
+  CHECK(manager.getAllTasks().size() == 1);
+}
+
+static void testRanking() {
+  TaskManager manager;
+  manager.addTask("Buy milk", "after the team meeting");
+  manager.addTask("Team meeting");
+  manager.addTask("Meetup");
+
+  std::vector<Task*> hits = manager.searchTasks("meetng");
+  CHECK(!hits.empty() && hits[0]->getTitle() == "Team meeting");
+  hits = manager.searchTasks("meeting");
+  CHECK(hits.size() == 2);
+  if (hits.size() == 2) {
+    CHECK(hits[0]->getTitle() == "Team meeting");  // title beats description
+  }
+  CHECK(manager.searchTasks("meeting", 1).size() == 1);
+}
+
+int main() {
+  std::mt19937 random = seededRandom();
+  testEditDistance(random);
+  testIncrementalMatchesFresh(random);
+  testLargeIds();
+  testRanking();
+  return TEST_RESULT();
+}
@@ -0,0 +1,50 @@
+// TaskSelector::parse: ids and ranges, queries, and the errors for
+// reversed ranges and ids outside 1..Task::MAX_ID (which must not wrap or
+// pass for a reversed range).
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "../include/TaskSelector.h"
+#include "TestSupport.h"
+
+static bool parses(const std::string& spec, TaskSelector& selector) {
+  std::string error;
+  return TaskSelector::parse(spec, selector, error);
+}
+
+static std::string parseError(const std::string& spec) {
+  TaskSelector selector;
+  std::string error;
+  CHECK(!TaskSelector::parse(spec, selector, error));
+  return error;
+}
+
+static void testIds() {
+  TaskSelector selector;
+  CHECK(parses("3, 8,10-14", selector) && !selector.isQuery());
+  std::vector<std::pair<int, int>> expected = {{3, 3}, {8, 8}, {10, 14}};
+  CHECK(selector.getIdRanges() == expected);
+  CHECK(parses("1-2147483646", selector));
+  CHECK(selector.containsId(Task::MAX_ID));
+  CHECK(parses("category:work done", selector) && selector.isQuery());
+}
+
+static void testErrors() {
+  CHECK(parseError(" ") == "Selection cannot be empty");
+  CHECK(parseError("9-5") == "Range is reversed: 9-5");
+  CHECK(parseError("1-2-3") == "Invalid id or range: 1-2-3");
+  const char* const outOfRange[] = {
+    "5-99999999999", "99999999999", "2147483647", "0-5", "5-2147483648",
+    "99999999999999999999-1"};
+  for (const char* spec : outOfRange) {
+    CHECK(parseError(spec).compare(0, 15, "Id out of range") == 0);
+  }
+}
+
+int main() {
+  testIds();
+  testErrors();
+  return TEST_RESULT();
+}
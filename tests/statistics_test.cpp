@@ -0,0 +1,192 @@
+// Applies random mutations through every TaskManager entry point that
+// changes tasks and checks after each one that the incrementally maintained
+// statistics equal a full recompute and the category index lists each
+// category's tasks in id order.
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "../include/TaskManager.h"
+#include "../include/TaskSelector.h"
+#include "../include/Utils.h"
+#include "TestSupport.h"
+
+static const int OPERATIONS = 20000;
+// Adds stop past this size so each step's full recompute stays cheap.
+static const size_t MAX_TASKS = 400;
+
+static int randomId(std::mt19937& random, TaskManager& manager) {
+  std::vector<Task*> tasks = manager.getAllTasks();
+  if (tasks.empty() || random() % 10 == 0)
+    return 1 + static_cast<int>(random() % 50);  // sometimes missing
+  return tasks[random() % tasks.size()]->getId();
+}
+
+static std::string randomCategory(std::mt19937& random) {
+  static const char* const categories[] = {"Work", "work", "Home", "Errands"};
+  return categories[random() % 4];
+}
+
+static std::string randomDueDate(std::mt19937& random) {
+  if (random() % 4 == 0)
+    return "";
+  return "2026-0" + std::to_string(1 + random() % 3) + "-1" +
+         std::to_string(random() % 10);
+}
+
+static Priority randomPriority(std::mt19937& random) {
+  return static_cast<Priority>(random() % 3);
+}
+
+static Recurrence randomRecurrence(std::mt19937& random) {
+  static const char* const rules[] = {"", "", "daily", "weekly", "monthly"};
+  Recurrence rule;
+  std::string error;
+  Recurrence::parse(rules[random() % 5], rule, error);
+  return rule;
+}
+
+static TaskSelector randomSelection(std::mt19937& random) {
+  int first = 1 + static_cast<int>(random() % 40);
+  return TaskSelector::range(first, first + static_cast<int>(random() % 10));
+}
+
+// A task as another instance might have saved it, with timestamps spread
+// over several days so the per-day counters move.
+static Task randomStoredTask(std::mt19937& random, int id) {
+  Task task(
+    id,
+    randomWord(random, 8),
+    "",
+    randomCategory(random),
+    randomDueDate(random),
+    randomPriority(random));
+  time_t created = 1767225600 + static_cast<time_t>(random() % 2000000);
+  bool completed = random() % 2;
+  task.restoreState(
+    completed,
+    created,
+    completed ? created + static_cast<time_t>(random() % 500000) : 0);
+  return task;
+}
+
+// Each category lists exactly its tasks, in id order, however they were
+// added, edited or moved.
+static bool categoryIndexMatches(TaskManager& manager) {
+  static const char* const keys[] = {"work", "home", "errands", "general"};
+  for (const char* key : keys) {
+    std::vector<int> expected;
+    for (Task* task : manager.getAllTasks()) {
+      if (Utils::toLowerCase(task->getCategory()) == key) {
+        expected.push_back(task->getId());
+      }
+    }
+    std::sort(expected.begin(), expected.end());
+
+    std::vector<int> listed;
+    for (Task* task : manager.getTasksByCategory(key)) {
+      listed.push_back(task->getId());
+    }
+    if (listed != expected)
+      return false;
+  }
+  return true;
+}
+
+int main() {
+  std::mt19937 random = seededRandom();
+  TaskManager manager;
+
+  for (int step = 0; step < OPERATIONS; ++step) {
+    int operation = static_cast<int>(random() % 16);
+    switch (operation) {
+      case 0:
+      case 1:
+      case 2:
+        if (manager.getAllTasks().size() >= MAX_TASKS) {
+          manager.deleteTask(randomId(random, manager));
+          break;
+        }
+        manager.addTask(
+          randomWord(random, 8),
+          randomWord(random, 12),
+          randomCategory(random),
+          randomDueDate(random),
+          randomPriority(random),
+          randomRecurrence(random));
+        break;
+      case 3:
+        manager.deleteTask(randomId(random, manager));
+        break;
+      case 4:
+      case 5:
+        manager.toggleTaskCompletion(randomId(random, manager));
+        break;
+      case 6:
+        manager.editTask(
+          randomId(random, manager),
+          randomWord(random, 8),
+          "",
+          randomCategory(random),
+          randomDueDate(random),
+          randomPriority(random));
+        break;
+      case 7:
+        manager.setTaskRecurrence(
+          randomId(random, manager), randomRecurrence(random));
+        break;
+      case 8:
+        manager.setTasksCompleted(randomSelection(random), random() % 2);
+        break;
+      case 9:
+        manager.recategorizeTasks(
+          randomSelection(random), randomCategory(random));
+        break;
+      case 10:
+        manager.reprioritizeTasks(
+          randomSelection(random), randomPriority(random));
+        break;
+      case 11:
+        if (random() % 4 == 0) {
+          manager.deleteTasks(randomSelection(random));
+        }
+        break;
+      case 12:
+        manager.restoreTask(randomStoredTask(random, manager.getNextId()));
+        manager.setNextId(manager.getNextId() + 1);
+        break;
+      case 13:
+        manager.applyStoredTask(
+          randomStoredTask(random, randomId(random, manager)));
+        break;
+      case 14:
+        if (random() % 2) {
+          manager.removeStoredTask(randomId(random, manager));
+        } else {
+          manager.renumberTask(randomId(random, manager));
+        }
+        break;
+      default:
+        if (random() % 200 == 0) {
+          manager.clearAllTasks();
+        }
+        break;
+    }
+
+    if (manager.getStatistics() != manager.recomputeStatistics()) {
+      std::cerr << "statistics diverged at step " << step << " (operation "
+                << operation << ")" << std::endl;
+      CHECK(false);
+      break;
+    }
+    if (!categoryIndexMatches(manager)) {
+      std::cerr << "category index diverged at step " << step
+                << " (operation " << operation << ")" << std::endl;
+      CHECK(false);
+      break;
+    }
+  }
+
+  return TEST_RESULT();
+}
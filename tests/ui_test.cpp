@@ -0,0 +1,127 @@
+// Task rows in the paged view: display width of wide, combining and
+// malformed text, truncation that never overflows, and control characters
+// in task text kept off the terminal (in rows and through printable()).
+
+#include <string>
+
+#include "../include/UIManager.h"
+#include "TestSupport.h"
+
+// The row without its colour codes (ESC [ ... m), as the terminal lays it
+// out.
+static std::string visibleText(const std::string& row) {
+  std::string text;
+  for (size_t i = 0; i < row.size(); ++i) {
+    if (row[i] == '\033' && i + 1 < row.size() && row[i + 1] == '[') {
+      size_t end = row.find('m', i);
+      if (end != std::string::npos) {
+        i = end;
+        continue;
+      }
+    }
+    text += row[i];
+  }
+  return text;
+}
+
+static void testDisplayWidth() {
+  CHECK(UIManager::displayWidth("") == 0);
+  CHECK(UIManager::displayWidth("plain") == 5);
+  CHECK(UIManager::displayWidth("caf\xC3\xA9") == 4);               // é
+  CHECK(UIManager::displayWidth("cafe\xCC\x81") == 4);              // combining
+  CHECK(UIManager::displayWidth("\xE6\x97\xA5\xE6\x9C\xAC") == 4);  // 日本
+  CHECK(UIManager::displayWidth("\xED\x95\x9C") == 2);              // 한
+  CHECK(UIManager::displayWidth("\xEF\xBC\xA1") == 2);              // Ａ
+  CHECK(UIManager::displayWidth("\xF0\x9F\x91\x8D") == 2);          // 👍
+  CHECK(UIManager::displayWidth("\xE2\x9C\x85") == 2);              // ✅
+  CHECK(UIManager::displayWidth("\xE2\x80\xA6") == 1);              // …
+  CHECK(UIManager::displayWidth("\xFF\xE6\x97") == 3);              // malformed
+}
+
+static void testTruncate() {
+  std::string wide = "\xE6\x97\xA5\xE6\x9C\xAC\xE8\xAA\x9E";  // 日本語
+  CHECK(UIManager::truncateToWidth(wide, 6) == wide);
+  // 日 and … fill three of four columns; 本 would straddle the limit.
+  CHECK(UIManager::truncateToWidth(wide, 4) == "\xE6\x97\xA5\xE2\x80\xA6");
+  CHECK(
+    UIManager::truncateToWidth(wide, 5) ==
+    "\xE6\x97\xA5\xE6\x9C\xAC\xE2\x80\xA6");
+  CHECK(UIManager::truncateToWidth(wide, 1) == "\xE2\x80\xA6");
+  CHECK(UIManager::truncateToWidth(wide, 0).empty());
+  // A combining mark stays with its letter.
+  CHECK(
+    UIManager::truncateToWidth("e\xCC\x81xyz", 2) == "e\xCC\x81\xE2\x80\xA6");
+}
+
+static void testTruncateRandom(std::mt19937& random) {
+  static const char* const pieces[] = {
+    "a", "Z", " ", "\xC3\xA9", "\xCC\x81", "\xE6\x97\xA5", "\xED\x95\x9C",
+    "\xF0\x9F\x91\x8D", "\xE2\x9C\x85", "\xEF\xBC\xA1"};
+  for (int i = 0; i < 20000; ++i) {
+    std::string text;
+    size_t count = random() % 30;
+    for (size_t j = 0; j < count; ++j) {
+      text += pieces[random() % 10];
+    }
+    size_t width = random() % 25;
+    std::string cut = UIManager::truncateToWidth(text, width);
+    CHECK(UIManager::displayWidth(cut) <= width);
+    if (cut != text && width > 0) {
+      // A prefix of the text, cut on a character boundary, then "…".
+      std::string kept = cut.substr(0, cut.size() - 3);
+      CHECK(text.compare(0, kept.size(), kept) == 0);
+      CHECK(UIManager::displayWidth(kept) + 2 >= width);
+    }
+  }
+}
+
+static void testRowSanitized() {
+  Task task(
+    12,
+    "evil\033[2J\033]0;pwned\a\rtitle\nmore\x7F\xC2\x9B",
+    "",
+    "Work\033[31m");
+  std::string row = UIManager::formatTaskRow(&task, 120);
+  std::string text = visibleText(row);
+  for (char c : text) {
+    CHECK(static_cast<unsigned char>(c) >= 0x20 && c != 0x7F);
+  }
+  CHECK(text.find("title") != std::string::npos);
+  CHECK(row.find("\033[2J") == std::string::npos);
+  CHECK(row.find("\033[31m)") == std::string::npos);  // not from the category
+}
+
+static void testPrintable() {
+  const std::string replaced = "\xEF\xBF\xBD";  // U+FFFD
+  CHECK(UIManager::printable("plain text") == "plain text");
+  CHECK(UIManager::printable("caf\xC3\xA9") == "caf\xC3\xA9");
+  CHECK(UIManager::printable("a\033[2Jb") == "a" + replaced + "[2Jb");
+  CHECK(UIManager::printable("\r\n\x7F") == replaced + replaced + replaced);
+  CHECK(UIManager::printable("\xC2\x9B\xFF") == replaced + replaced);
+}
+
+static void testRowWidth() {
+  std::string titles[] = {
+    "Plain title that is rather long for a narrow terminal window",
+    "\xE4\xBC\x9A\xE8\xAD\xB0\xE3\x81\xAE\xE6\xBA\x96\xE5\x82\x99\xE3\x82\x92"
+    "\xE3\x81\x99\xE3\x82\x8B\xE3\x81\x93\xE3\x81\xA8",
+    "Ship it \xF0\x9F\x9A\x80\xF0\x9F\x9A\x80\xF0\x9F\x9A\x80 now"};
+  for (const std::string& title : titles) {
+    Task task(4321, title, "", "Work", "2026-10-19", Priority::HIGH);
+    for (int width = 20; width <= 120; ++width) {
+      std::string text = visibleText(UIManager::formatTaskRow(&task, width));
+      CHECK(UIManager::displayWidth(text) <= static_cast<size_t>(width));
+    }
+  }
+}
+
+int main() {
+  std::mt19937 random = seededRandom();
+  testDisplayWidth();
+  testTruncate();
+  testTruncateRandom(random);
+  testRowSanitized();
+  testPrintable();
+  testRowWidth();
+  return TEST_RESULT();
+}